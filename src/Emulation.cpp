@@ -9,6 +9,9 @@
 // Own
 #include "Emulation.h"
 
+// Standard
+#include <cstring>
+
 // Qt
 #include <QKeyEvent>
 
@@ -21,6 +24,67 @@
 
 using namespace Konsole;
 
+/*
+   Decodes the UTF-8 sequence starting at @p src into @p codePoint.
+
+   Returns the number of bytes consumed, or 0 if the sequence is valid so far
+   but continues past @p end. Invalid sequences yield U+FFFD and consume only
+   their lead byte, like QStringDecoder does.
+*/
+static int decodeUtf8Sequence(const uchar *src, const uchar *end, uint &codePoint)
+{
+    const uchar lead = *src;
+    int needed;
+    uint value;
+    // valid range of the first continuation byte, excluding overlong forms and surrogates
+    uchar min = 0x80;
+    uchar max = 0xBF;
+
+    if (lead < 0x80) {
+        codePoint = lead;
+        return 1;
+    } else if (lead >= 0xC2 && lead <= 0xDF) {
+        needed = 1;
+        value = lead & 0x1F;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        needed = 2;
+        value = lead & 0x0F;
+        if (lead == 0xE0) {
+            min = 0xA0;
+        } else if (lead == 0xED) {
+            max = 0x9F;
+        }
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        needed = 3;
+        value = lead & 0x07;
+        if (lead == 0xF0) {
+            min = 0x90;
+        } else if (lead == 0xF4) {
+            max = 0x8F;
+        }
+    } else {
+        codePoint = QChar::ReplacementCharacter;
+        return 1;
+    }
+
+    for (int i = 1; i <= needed; ++i) {
+        if (src + i == end) {
+            return 0;
+        }
+        const uchar b = src[i];
+        if (b < min || b > max) {
+            codePoint = QChar::ReplacementCharacter;
+            return 1;
+        }
+        min = 0x80;
+        max = 0xBF;
+        value = (value << 6) | (b & 0x3F);
+    }
+
+    codePoint = value;
+    return needed + 1;
+}
+
 Emulation::Emulation()
 {
     // create screens with a default size
@@ -149,6 +213,7 @@ void Emulation::setScreenInternal(int index)
 void Emulation::clearHistory()
 {
     if (_currentScreen == _screen[0]) {
+        _droppedLineCount += _screen[0]->getHistLines();
         Q_EMIT updateDroppedLines(_screen[0]->getHistLines());
     }
 
@@ -158,6 +223,7 @@ void Emulation::clearHistory()
 void Emulation::setHistory(const HistoryType &history)
 {
     _screen[0]->setScroll(history);
+    Q_EMIT historyChanged();
 
     showBulk();
 }
@@ -176,6 +242,9 @@ bool Emulation::setCodec(const QByteArray &name)
         if (decoder.isValid() && encoder.isValid()) {
             _decoder = std::move(decoder);
             _encoder = std::move(encoder);
+            _utf8Decoding = utf8();
+            _utf8AtStart = true;
+            _utf8PendingLength = 0;
             Q_EMIT useUtf8Request(utf8());
             return true;
         }
@@ -261,9 +330,11 @@ void Emulation::receiveData(const char *text, int length)
     bufferedUpdate();
 
     // send characters to terminal emulator
-    const QString readString = _decoder.decode(QByteArrayView(text, length));
-    const QVector<uint> chars = readString.toUcs4();
+    // (the buffer is moved out while in use, in case receiveChars() ends up here again)
+    QVector<uint> chars = std::move(_receiveBuffer);
+    decodeReceivedData(text, length, chars);
     receiveChars(chars);
+    _receiveBuffer = std::move(chars);
 
     if (KonsoleSettings::listenForZModemTerminalCodes() == false) {
         return;
@@ -290,11 +361,157 @@ void Emulation::receiveData(const char *text, int length)
     }
 }
 
+void Emulation::decodeReceivedData(const char *text, int length, QVector<uint> &chars)
+{
+    if (_utf8Decoding) {
+        decodeUtf8(text, length, chars);
+        return;
+    }
+
+    const QString readString = _decoder.decode(QByteArrayView(text, length));
+
+    // same as QString::toUcs4(), but into the existing buffer
+    chars.resize(readString.size());
+    uint *out = chars.data();
+    const QChar *src = readString.constData();
+    const QChar *const end = src + readString.size();
+    while (src < end) {
+        uint c = src->unicode();
+        if (QChar::isHighSurrogate(c) && src + 1 < end && src[1].isLowSurrogate()) {
+            c = QChar::surrogateToUcs4(src[0], src[1]);
+            src += 2;
+        } else {
+            if (QChar::isSurrogate(c)) {
+                c = QChar::ReplacementCharacter;
+            }
+            ++src;
+        }
+        *out++ = c;
+    }
+    chars.resize(out - chars.constData());
+}
+
+void Emulation::decodeUtf8(const char *text, int length, QVector<uint> &chars)
+{
+    // at most one code point per byte, including those left over from the previous block
+    chars.resize(length + _utf8PendingLength);
+    uint *out = chars.data();
+
+    auto src = reinterpret_cast<const uchar *>(text);
+    const uchar *const end = src + length;
+
+    // complete a sequence that was split across the previous block
+    while (_utf8PendingLength > 0) {
+        const int pending = _utf8PendingLength;
+        const int taken = qMin(int(sizeof(_utf8Pending)) - pending, int(end - src));
+        uchar sequence[sizeof(_utf8Pending)];
+        memcpy(sequence, _utf8Pending, pending);
+        memcpy(sequence + pending, src, taken);
+
+        uint codePoint;
+        const int used = decodeUtf8Sequence(sequence, sequence + pending + taken, codePoint);
+        if (used == 0) {
+            // still incomplete, wait for more data
+            memcpy(_utf8Pending + pending, src, taken);
+            _utf8PendingLength = pending + taken;
+            src = end;
+            break;
+        }
+
+        *out++ = codePoint;
+        if (used >= pending) {
+            src += used - pending;
+            _utf8PendingLength = 0;
+        } else {
+            memmove(_utf8Pending, _utf8Pending + used, pending - used);
+            _utf8PendingLength = pending - used;
+        }
+    }
+
+    while (src < end) {
+        // ASCII fast path: widen eight bytes at a time while none has the high bit set
+        while (end - src >= 8) {
+            quint64 word;
+            memcpy(&word, src, sizeof(word));
+            if (word & Q_UINT64_C(0x8080808080808080)) {
+                break;
+            }
+            for (int i = 0; i < 8; ++i) {
+                out[i] = src[i];
+            }
+            out += 8;
+            src += 8;
+        }
+        if (src == end) {
+            break;
+        }
+        if (*src < 0x80) {
+            *out++ = *src++;
+            continue;
+        }
+
+        uint codePoint;
+        const int used = decodeUtf8Sequence(src, end, codePoint);
+        if (used == 0) {
+            // keep the start of a split sequence for the next block
+            _utf8PendingLength = end - src;
+            memcpy(_utf8Pending, src, _utf8PendingLength);
+            break;
+        }
+        *out++ = codePoint;
+        src += used;
+    }
+
+    chars.resize(out - chars.constData());
+
+    // a byte order mark at the start of the stream is dropped, as QStringDecoder does
+    if (_utf8AtStart && !chars.isEmpty()) {
+        _utf8AtStart = false;
+        if (chars.at(0) == 0xFEFF) {
+            chars.removeFirst();
+        }
+    }
+}
+
 void Emulation::writeToStream(TerminalCharacterDecoder *decoder, int startLine, int endLine)
 {
     _currentScreen->writeLinesToStream(decoder, startLine, endLine);
 }
 
+void Emulation::setSearchIndexAllowed(bool allowed)
+{
+    _searchIndexAllowed = allowed;
+    if (!allowed) {
+        _screen[0]->setSearchIndexEnabled(false);
+    }
+}
+
+void Emulation::setSearchIndexEnabled(bool enable)
+{
+    // only the primary screen has a history
+    _screen[0]->setSearchIndexEnabled(enable && _searchIndexAllowed);
+}
+
+bool Emulation::isSearchIndexEnabled() const
+{
+    return _screen[0]->isSearchIndexEnabled();
+}
+
+bool Emulation::searchCandidates(const QString &literal, QVector<std::pair<int, int>> *ranges)
+{
+    return _currentScreen->searchCandidates(literal, ranges);
+}
+
+bool Emulation::buildSearchIndex(int maxLines)
+{
+    return _currentScreen->buildSearchIndex(maxLines);
+}
+
+qint64 Emulation::droppedLineCount() const
+{
+    return _droppedLineCount + _currentScreen->fastDroppedLines() + _currentScreen->droppedLines();
+}
+
 int Emulation::lineCount() const
 {
     // sum number of lines currently on _screen plus number of lines in history
@@ -308,6 +525,7 @@ void Emulation::showBulk()
     _bulkTimer1.stop();
     _bulkTimer2.stop();
 
+    _droppedLineCount += _currentScreen->fastDroppedLines() + _currentScreen->droppedLines();
     Q_EMIT updateDroppedLines(_currentScreen->fastDroppedLines() + _currentScreen->droppedLines());
     Q_EMIT outputChanged();
 
@@ -13,6 +13,7 @@
 #include <QStringDecoder>
 #include <QStringEncoder>
 #include <QTimer>
+#include <QVector>
 
 // Konsole
 #include "Enumeration.h"
@@ -20,6 +21,7 @@
 #include "terminalDisplay/TerminalDisplay.h"
 
 #include <memory>
+#include <utility>
 
 class QKeyEvent;
 
@@ -109,6 +111,14 @@ public:
      */
     int lineCount() const;
 
+    /**
+     * Returns the number of lines dropped from the top of the output since the
+     * emulation was created, including those which updateDroppedLines() has
+     * not reported yet.  Adding it to a line number gives a number which stays
+     * the same for that line while lines are dropped.
+     */
+    qint64 droppedLineCount() const;
+
     /**
      * Sets the history store used by this emulation.  When new lines
      * are added to the output, older lines at the top of the screen are transferred to a history
@@ -136,6 +146,36 @@ public:
      */
     virtual void writeToStream(TerminalCharacterDecoder *decoder, int startLine, int endLine);
 
+    /**
+     * Allows the history to keep a search index.  This is off by default, as
+     * the index takes memory for every line of the history.  Disallowing it
+     * frees the index.
+     */
+    void setSearchIndexAllowed(bool allowed);
+
+    /**
+     * Enables or disables the search index of the history, if it is allowed by
+     * setSearchIndexAllowed().  The index is built when it is used, and is freed
+     * when it is disabled.  See Screen::setSearchIndexEnabled()
+     */
+    void setSearchIndexEnabled(bool enable);
+    /** Returns true if the search index of the history is enabled.  See setSearchIndexEnabled() */
+    bool isSearchIndexEnabled() const;
+
+    /**
+     * Stores the ranges of lines which may contain @p literal in @p ranges,
+     * using the search index of the history.  See Screen::searchCandidates()
+     *
+     * Returns false if all lines have to be searched.
+     */
+    bool searchCandidates(const QString &literal, QVector<std::pair<int, int>> *ranges);
+
+    /**
+     * Builds the search index of the history, indexing at most @p maxLines
+     * lines.  See Screen::buildSearchIndex()
+     */
+    bool buildSearchIndex(int maxLines);
+
     /** Returns the decoder used to decode incoming characters.  See setCodec() */
     const QStringDecoder &decoder() const
     {
@@ -450,6 +490,12 @@ Q_SIGNALS:
      */
     void updateDroppedLines(int droppedLines);
 
+    /**
+     * Emitted when the history is replaced or resized by setHistory(), which
+     * may drop lines from it without them being counted by updateDroppedLines().
+     */
+    void historyChanged();
+
     /**
      * Emitted after receiving the escape sequence which asks to
      * display progress.
@@ -536,6 +582,9 @@ private Q_SLOTS:
 
 private:
     void setScreenInternal(int index);
+    // decodes a block received from the terminal into @p chars, reusing its storage
+    void decodeReceivedData(const char *text, int length, QVector<uint> &chars);
+    void decodeUtf8(const char *text, int length, QVector<uint> &chars);
     Q_DISABLE_COPY(Emulation)
 
     bool _usesMouseTracking = false;
@@ -546,6 +595,18 @@ private:
     bool _imageSizeInitialized = false;
     bool _peekingPrimary = false;
     int _activeScreenIndex = 0;
+    // lines reported by updateDroppedLines() so far
+    qint64 _droppedLineCount = 0;
+    bool _searchIndexAllowed = false;
+
+    // code points of the last received block, kept to reuse its allocation
+    QVector<uint> _receiveBuffer;
+
+    // state of the built-in UTF-8 decoder used instead of _decoder for UTF-8 codecs
+    bool _utf8Decoding = false;
+    bool _utf8AtStart = true;
+    uchar _utf8Pending[4] = {};
+    int _utf8PendingLength = 0;
 };
 }
 
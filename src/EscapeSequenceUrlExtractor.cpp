@@ -11,6 +11,9 @@
 #include <QHostInfo>
 #include <QUrl>
 
+#include <algorithm>
+#include <limits>
+
 namespace Konsole
 {
 EscapeSequenceUrlExtractor::EscapeSequenceUrlExtractor() = default;
@@ -72,7 +75,14 @@ void EscapeSequenceUrlExtractor::endUrlInput()
     const int realCcolumn = _screen->getCursorY() + _screen->getHistLines();
     const auto currentPos = Coordinate{realCcolumn, _screen->getCursorX()};
     _currentUrl.end = currentPos;
-    _history.append(_currentUrl);
+    _currentUrl.begin.row += _removedLines;
+    _currentUrl.end.row += _removedLines;
+
+    // URL's are nearly always written below the previous ones
+    const auto position = std::upper_bound(_history.begin(), _history.end(), _currentUrl.begin.row, [](int row, const ExtractedUrl &url) {
+        return row < url.begin.row;
+    });
+    _history.insert(position, _currentUrl);
 
     _currentUrl = ExtractedUrl{};
 }
@@ -80,16 +90,18 @@ void EscapeSequenceUrlExtractor::endUrlInput()
 void EscapeSequenceUrlExtractor::clear()
 {
     _history.clear();
+    _removedLines = 0;
 }
 
 void EscapeSequenceUrlExtractor::clearBetween(int loca, int loce)
 {
-    _history.removeIf([&](const ExtractedUrl &url) {
-        int beginLoc = url.begin.row * _screen->getColumns() + url.begin.col;
-        int endLoc = url.end.row * _screen->getColumns() + url.end.col;
+    const auto toRemove = std::remove_if(_history.begin(), _history.end(), [&](const ExtractedUrl &url) {
+        int beginLoc = (url.begin.row - _removedLines) * _screen->getColumns() + url.begin.col;
+        int endLoc = (url.end.row - _removedLines) * _screen->getColumns() + url.end.col;
 
         return (loca <= beginLoc && beginLoc <= loce) || (loca <= endLoc && endLoc <= loce);
     });
+    _history.erase(toRemove, _history.end());
 }
 
 void EscapeSequenceUrlExtractor::setAllowedLinkSchema(const QStringList &schema)
@@ -99,22 +111,52 @@ void EscapeSequenceUrlExtractor::setAllowedLinkSchema(const QStringList &schema)
 
 void EscapeSequenceUrlExtractor::historyLinesRemoved(int lines)
 {
-    for (auto &url : _history) {
-        url.begin.row -= lines;
-        url.end.row -= lines;
+    // the stored rows only have to be rewritten once the count of removed lines
+    // gets close to overflowing, which leaves plenty of lines in between
+    if (_removedLines > std::numeric_limits<int>::max() / 2) {
+        for (auto &url : _history) {
+            url.begin.row -= _removedLines;
+            url.end.row -= _removedLines;
+        }
+        _removedLines = 0;
     }
-    _history.erase(std::remove_if(std::begin(_history),
-                                  std::end(_history),
-                                  [](const ExtractedUrl &url) {
-                                      const bool toRemove = url.begin.row < 0;
-                                      return toRemove;
-                                  }),
-                   std::end(_history));
+
+    _removedLines += lines;
+    while (!_history.empty() && _history.front().begin.row < _removedLines) {
+        _history.pop_front();
+    }
+}
+
+ExtractedUrl EscapeSequenceUrlExtractor::fromStored(const ExtractedUrl &url) const
+{
+    ExtractedUrl result = url;
+    result.begin.row -= _removedLines;
+    result.end.row -= _removedLines;
+    return result;
 }
 
 QVector<ExtractedUrl> EscapeSequenceUrlExtractor::history() const
 {
-    return _history;
+    QVector<ExtractedUrl> urls;
+    urls.reserve(_history.size());
+    for (const auto &url : _history) {
+        urls.append(fromStored(url));
+    }
+    return urls;
+}
+
+QVector<ExtractedUrl> EscapeSequenceUrlExtractor::urlsBetween(int firstRow, int lastRow) const
+{
+    QVector<ExtractedUrl> urls;
+    auto it = std::lower_bound(_history.cbegin(), _history.cend(), firstRow + _removedLines, [](const ExtractedUrl &url, int row) {
+        return url.begin.row < row;
+    });
+    for (; it != _history.cend() && it->begin.row <= lastRow + _removedLines; ++it) {
+        if (it->end.row <= lastRow + _removedLines) {
+            urls.append(fromStored(*it));
+        }
+    }
+    return urls;
 }
 
 void Konsole::EscapeSequenceUrlExtractor::toggleUrlInput()
@@ -10,6 +10,8 @@
 
 #include <QObject>
 
+#include <deque>
+
 #include "konsoleprivate_export.h"
 
 namespace Konsole
@@ -58,8 +60,16 @@ private:
      */
     // Not used ATM const int _maximumUrlHistory = 200;
 
-    /* All of the extracted URL's. */
-    QVector<ExtractedUrl> _history;
+    /* All of the extracted URL's, ordered by their first row.
+     * The rows count from the first line ever written to the history,
+     * so that dropping lines from the history doesn't move them.
+     */
+    std::deque<ExtractedUrl> _history;
+
+    /* Number of lines dropped from the history: the row stored for
+     * the first line of the history.
+     */
+    int _removedLines = 0;
 
     /* The URI schema format that's accepted */
     QStringList _allowedUriSchemas;
@@ -69,6 +79,9 @@ private:
 
     void appendUrlText_impl(uint c);
 
+    /* Converts the rows of url between stored and screen coordinates. */
+    ExtractedUrl fromStored(const ExtractedUrl &url) const;
+
 public:
     /* This needs to have access to the Session
      * calculate the row / col of the current URL.
@@ -114,14 +127,18 @@ public:
      * on screen. */
     QVector<ExtractedUrl> history() const;
 
+    /* The parsed URL's which lie between the rows firstRow and lastRow. */
+    QVector<ExtractedUrl> urlsBetween(int firstRow, int lastRow) const;
+
     /* Clear all the URL's, this is triggered when the Screen is cleared. */
     void clear();
 
     /* Clear all the URL's between the given locations. Triggered when parts of the Screen are cleared. */
     void clearBetween(int loca, int loce);
 
-    /* Iterates through all the URL's and remove the ones that are currently
-     * out of bounds because we removed lines in the History
+    /* Moves all the URL's up by the lines removed from the History and removes
+     * the ones that are now out of bounds.  This only has to look at the URL's
+     * which are removed.
      */
     void historyLinesRemoved(int lines);
 
@@ -71,6 +71,16 @@ void HistorySizeDialog::setLineCount(int lines)
     _ui->historySizeWidget->setLineCount(lines);
 }
 
+void HistorySizeDialog::setCompressed(bool compressed)
+{
+    _ui->historySizeWidget->setCompressed(compressed);
+}
+
+bool HistorySizeDialog::isCompressed() const
+{
+    return _ui->historySizeWidget->isCompressed();
+}
+
 QSize HistorySizeDialog::sizeHint() const
 {
     return {_ui->tempWarningWidget->sizeHint().width(), 0};
@@ -42,6 +42,12 @@ public:
     /** See HistorySizeWidget::lineCount. */
     int lineCount() const;
 
+    /** See HistorySizeWidget::setCompressed. */
+    void setCompressed(bool compressed);
+
+    /** See HistorySizeWidget::isCompressed. */
+    bool isCompressed() const;
+
     QSize sizeHint() const override;
 
 private:
@@ -179,6 +179,11 @@ bool Pty::flowControlEnabled() const
     }
 }
 
+void Pty::setReadSuspended(bool suspended)
+{
+    pty()->setSuspended(suspended);
+}
+
 void Pty::setEchoEnabled(bool enable)
 {
     if (pty()->masterFd() >= 0) {
@@ -489,6 +494,10 @@ bool Pty::flowControlEnabled() const
     return false;
 }
 
+void Pty::setReadSuspended(bool)
+{
+}
+
 void Pty::setUtf8Mode(bool)
 {
 }
@@ -113,6 +113,12 @@ public:
     /** Queries the terminal state and returns true if Xon/Xoff flow control is enabled. */
     bool flowControlEnabled() const;
 
+    /**
+     * Stops or resumes reading output from the terminal process.  While suspended,
+     * output stays in the kernel buffer and the process blocks once it is full.
+     */
+    void setReadSuspended(bool suspended);
+
     /**
      * Enables or disables local echo on the PTY.
      * When disabled, characters sent to the PTY are not echoed back by the terminal driver.
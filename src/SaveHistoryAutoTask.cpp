@@ -28,10 +28,15 @@ QString SaveHistoryAutoTask::_saveDialogRecentURL;
 
 SaveHistoryAutoTask::SaveHistoryAutoTask(QObject *parent)
     : SessionTask(parent)
-    , _droppedBytes(0)
     , _bytesLines(0)
+    , _finalLines(0)
+    , _endBytes(0)
+    , _pendingWrites(0)
+    , _stopped(false)
     , _pendingChanges(false)
 {
+    _decoder.setRecordLinePositions(true);
+    _writePool.setMaxThreadCount(1);
 }
 
 SaveHistoryAutoTask::~SaveHistoryAutoTask() = default;
@@ -119,24 +124,16 @@ void SaveHistoryAutoTask::fileModified()
 void SaveHistoryAutoTask::linesDropped(int linesDropped)
 {
     if (linesDropped > 0) {
-        if (linesDropped > _bytesLines.count()) {
-            readLines();
-        }
-
-        if (linesDropped == _bytesLines.size()) {
-            _droppedBytes = _destinationFile.size();
-        } else {
-            _droppedBytes = _bytesLines[linesDropped];
-        }
-
-        for (int i = 0; i < linesDropped; ++i) {
-            _bytesLines.pop_front();
-        }
+        // lines dropped before they were ever written are lost
+        _bytesLines.remove(0, qMin(linesDropped, int(_bytesLines.size())));
+        _finalLines = qMax(0, _finalLines - linesDropped);
     }
 }
 
 void SaveHistoryAutoTask::stop()
 {
+    _stopped = true;
+    _writePool.clear();
     Q_EMIT completed(true);
     disconnect();
 
@@ -147,7 +144,7 @@ void SaveHistoryAutoTask::stop()
 
 void SaveHistoryAutoTask::imageResized(int /*rows*/, int /*columns*/)
 {
-    updateByteLineAnchors();
+    _finalLines = 0;
 }
 
 void SaveHistoryAutoTask::linesChanged()
@@ -168,81 +165,75 @@ void SaveHistoryAutoTask::readLines()
 
     _timer.stop();
 
-    if (!updateArchive()) {
-        stop();
-        KMessageBox::error(nullptr, i18n("Failed to update autosave state on output changes."));
-        return;
-    }
-
-    updateByteLineAnchors();
+    updateArchive();
 
     _pendingChanges = false;
     _timer.start(timerInterval());
 }
 
-bool SaveHistoryAutoTask::updateArchive()
+void SaveHistoryAutoTask::updateArchive()
 {
-    _watcher.removePath(_destinationFile.fileName());
-
-    QTextStream stream(&_destinationFile);
+    Emulation *emulation = session()->emulation();
+    const int lineCount = emulation->lineCount();
+    const int historyLines = lineCount - emulation->imageSize().height();
 
-    if (!_destinationFile.resize(_droppedBytes) || !stream.seek(_destinationFile.size())) {
-        return false;
-    }
+    // Everything from the first line that is not final yet is rewritten
+    _finalLines = qMin(_finalLines, int(_bytesLines.size()));
+    const qint64 offset = _finalLines < _bytesLines.size() ? _bytesLines[_finalLines] : _endBytes;
+    _bytesLines.resize(_finalLines);
 
+    QString text;
+    QTextStream stream(&text);
     _decoder.begin(&stream);
-    session()->emulation()->writeToStream(&_decoder, 0, session()->emulation()->lineCount() - 1);
+    emulation->writeToStream(&_decoder, _finalLines, lineCount - 1);
     _decoder.end();
     stream.flush();
 
-    if (stream.status() != QTextStream::Ok) {
-        return false;
+    // Encode line by line to know where each line starts in the file
+    const QList<int> linePositions = _decoder.linePositions();
+    const int lines = lineCount - _finalLines;
+    QByteArray data;
+    for (int i = 0; i < lines; ++i) {
+        _bytesLines.append(offset + data.size());
+        const int from = linePositions.value(i, text.size());
+        const int to = i + 1 < lines ? linePositions.value(i + 1, text.size()) : text.size();
+        data += QStringView(text).mid(from, to - from).toUtf8();
     }
 
-    _watcher.addPath(_destinationFile.fileName());
+    _finalLines = qMax(0, historyLines);
+    _endBytes = offset + data.size();
 
-    return true;
+    _watcher.removePath(_destinationFile.fileName());
+    ++_pendingWrites;
+    _writePool.start([this, offset, data]() {
+        const bool success = _destinationFile.seek(offset) && _destinationFile.write(data) == data.size() && _destinationFile.flush()
+            && _destinationFile.resize(offset + data.size());
+        QMetaObject::invokeMethod(
+            this,
+            [this, success]() {
+                writeFinished(success);
+            },
+            Qt::QueuedConnection);
+    });
 }
 
-void SaveHistoryAutoTask::updateByteLineAnchors()
+void SaveHistoryAutoTask::writeFinished(bool success)
 {
-    if (session().isNull()) {
-        stop();
+    --_pendingWrites;
+
+    if (_stopped) {
         return;
     }
 
-    qint64 currentByte = _droppedBytes;
-    QList<int> lineLengths = session()->emulation()->getCurrentScreenCharacterCounts();
-
-    _bytesLines.resize(lineLengths.size());
-    _destinationFile.seek(currentByte);
-
-    for (int i = 0; i < lineLengths.size(); ++i) {
-        _bytesLines[i] = currentByte;
-        QString line;
-
-        int lineNumChars = lineLengths[i];
-
-        for (int j = 0; j < lineNumChars; ++j) {
-            char c;
-
-            if (!_destinationFile.getChar(&c)) {
-                qDebug() << "LINE " << (i + 1) << " (" << lineNumChars << ") : " << line;
-                qDebug() << "INVALID";
-                return;
-            }
-
-            line.append(QLatin1Char(c));
-        }
-
-        currentByte = _destinationFile.pos();
-        qDebug() << "LINE " << (i + 1) << " (" << lineNumChars << ") : " << line;
+    if (!success) {
+        stop();
+        KMessageBox::error(nullptr, i18n("Failed to update autosave state on output changes."));
+        return;
     }
 
-    if (_destinationFile.atEnd())
-        qDebug() << "VALID";
-    else
-        qDebug() << "INVALID";
+    if (_pendingWrites == 0) {
+        _watcher.addPath(_destinationFile.fileName());
+    }
 }
 
 const QPointer<Session> &SaveHistoryAutoTask::session() const
@@ -9,6 +9,7 @@
 
 #include <QFile>
 #include <QFileSystemWatcher>
+#include <QThreadPool>
 #include <QTimer>
 
 #include "../decoders/PlainTextDecoder.h"
@@ -44,14 +45,14 @@ public Q_SLOTS:
 
 private Q_SLOTS:
     /**
-     * Increases _droppedBytes using info in _bytesLines when lines
-     * have been dropped from the screen and history.
+     * Forgets the anchors of lines that have been dropped from the screen
+     * and history; their content stays in the autosave file.
      */
     void linesDropped(int linesDropped);
 
     /**
-     * Resets _bytesLines since the lines on the screen changes when
-     * the screen is resized.
+     * Makes the next update rewrite all lines, since resizing the screen
+     * may reflow the history.
      */
     void imageResized(int rows, int columns);
 
@@ -68,10 +69,14 @@ private:
     // Reads the session output.
     void readLines();
 
-    bool updateArchive();
+    /**
+     * Appends the history lines that were added since the last update
+     * and rewrites the screen lines after them.
+     */
+    void updateArchive();
 
-    // Updates _bytesLines.
-    void updateByteLineAnchors();
+    // Called on the main thread once a write queued by updateArchive() is done.
+    void writeFinished(bool success);
 
     const QPointer<Session> &session() const;
 
@@ -90,9 +95,6 @@ private:
      */
     QFileSystemWatcher _watcher;
 
-    // Number of bytes used to accommodate dropped content in the autosave file.
-    qint64 _droppedBytes;
-
     /**
      * A list of byte offsets in _destinationFile.
      * Each offset corresponds to the first of a series of bytes
@@ -100,6 +102,20 @@ private:
      */
     QList<qint64> _bytesLines;
 
+    /**
+     * Number of lines at the start of _bytesLines that are in the history and
+     * so will not change anymore; they are not written again.
+     */
+    int _finalLines;
+
+    // Number of bytes in _destinationFile once all queued writes are done.
+    qint64 _endBytes;
+
+    // Number of writes queued on _writePool that have not finished yet.
+    int _pendingWrites;
+
+    bool _stopped;
+
     PlainTextDecoder _decoder;
 
     // Used to time how often the output should be re-read.
@@ -112,6 +128,14 @@ private:
     bool _pendingChanges;
 
     static QString _saveDialogRecentURL;
+
+    /**
+     * Writes to _destinationFile happen on this single thread, in the
+     * order they were queued, so that slow disks do not block the GUI.
+     * Declared last so that it waits for the writes before the rest of
+     * the task is destroyed.
+     */
+    QThreadPool _writePool;
 };
 
 }
@@ -72,6 +72,7 @@ Screen::Screen(int lines, int columns)
     , _isResize(false)
     , _enableReflowLines(false)
     , _lineProperties(_lines + 1)
+    , _lineDamageStamps(_lines + 1, 0)
     , _history(std::make_unique<HistoryScrollNone>())
     , _cuX(0)
     , _cuY(0)
@@ -348,6 +349,7 @@ void Screen::reverseIndex()
 void Screen::nextLine()
 //=NEL
 {
+    damageLines(_cuY, _cuY);
     _lineProperties[_cuY].length = _cuX;
     toStartOfLine();
     index();
@@ -370,6 +372,7 @@ void Screen::eraseBlock(int y, int x, int height, int width)
     width = qBound(0, width, _columns - x - 1);
     int endCol = x + width;
     height = qBound(0, height, _lines - y - 1);
+    damageLines(y, y + height - 1);
     Character chr(' ', CharacterColor(COLOR_SPACE_DEFAULT, DEFAULT_FORE_COLOR), CharacterColor(COLOR_SPACE_DEFAULT, DEFAULT_BACK_COLOR), RE_TRANSPARENT, 0);
     for (int row = y; row < y + height; row++) {
         QVector<Character> &line = _screenLines[row];
@@ -406,6 +409,7 @@ void Screen::deleteChars(int n)
     Q_ASSERT(n >= 0);
     Q_ASSERT(_cuX + n <= _screenLines.at(_cuY).count());
 
+    damageLines(_cuY, _cuY);
     _screenLines[_cuY].remove(_cuX, n);
 
     // Append space(s) with current attributes
@@ -422,6 +426,7 @@ void Screen::insertChars(int n)
         n = 1; // Default
     }
 
+    damageLines(_cuY, _cuY);
     if (_screenLines.at(_cuY).size() < _cuX) {
         _screenLines[_cuY].resize(_cuX);
     }
@@ -476,6 +481,9 @@ void Screen::insertLines(int n)
 
 void Screen::setMode(int m)
 {
+    if (m == MODE_Screen && _currentModes[m] != 1) {
+        damageAll();
+    }
     _currentModes[m] = 1;
     switch (m) {
     case MODE_Origin:
@@ -487,6 +495,9 @@ void Screen::setMode(int m)
 
 void Screen::resetMode(int m)
 {
+    if (m == MODE_Screen && _currentModes[m] != 0) {
+        damageAll();
+    }
     _currentModes[m] = 0;
     switch (m) {
     case MODE_Origin:
@@ -503,6 +514,9 @@ void Screen::saveMode(int m)
 
 void Screen::restoreMode(int m)
 {
+    if (m == MODE_Screen && _currentModes[m] != _savedModes[m]) {
+        damageAll();
+    }
     _currentModes[m] = _savedModes[m];
 }
 
@@ -726,6 +740,8 @@ void Screen::resizeImage(int new_lines, int new_columns)
         std::fill(_lineProperties.begin() + _screenLines.size(), _lineProperties.end(), LineProperty());
     }
     _screenLines.resize(new_lines + 1);
+    _lineDamageStamps.resize(new_lines + 1);
+    damageAll();
 
     _screenLinesSize = new_lines;
     _lines = new_lines;
@@ -908,8 +924,9 @@ void Screen::getImage(Character *dest, int size, int startLine, int endLine) con
 
     int visX = qMin(_cuX, getScreenLineColumns(_cuY) - 1);
     // mark the character at the current cursor position
-    int cursorIndex = loc(visX, _cuY + linesInHistoryBuffer);
-    if (getMode(MODE_Cursor) && cursorIndex < _columns * mergedLines) {
+    const int cursorLine = _cuY + _history->getLines() - startLine;
+    int cursorIndex = loc(visX, cursorLine);
+    if (getMode(MODE_Cursor) && cursorLine >= 0 && cursorIndex < _columns * mergedLines) {
         dest[cursorIndex].rendition.f.cursor = 1;
     }
     cursorIndex = loc(_selCuX, _selCuY - startLine + _history->getLines());
@@ -1012,6 +1029,7 @@ void Screen::backspace()
     _cuX = qMax(0, _cuX - 1);
 
     if (_screenLines.at(_cuY).size() < _cuX + 1) {
+        damageLines(_cuY, _cuY);
         _screenLines[_cuY].resize(_cuX + 1);
     }
 }
@@ -1075,11 +1093,13 @@ void Screen::initTabStops()
 void Screen::newLine()
 {
     if (getMode(MODE_NewLine)) {
+        damageLines(_cuY, _cuY);
         _lineProperties[_cuY].length = _cuX;
         toStartOfLine();
     }
 
     index();
+    damageLines(_cuY, _cuY);
     _lineProperties[_cuY].counter = commandCounter;
 }
 
@@ -1148,6 +1168,7 @@ void Screen::displayCharacter(uint c)
             }
         }
 
+        damageLines(charToCombineWithY, charToCombineWithY);
         Character &currentChar = _screenLines[charToCombineWithY][charToCombineWithX];
 
         if (c == 0x20E3) {
@@ -1279,6 +1300,7 @@ notcombine:
     }
 
     _lastPos = loc(_cuX, _cuY);
+    damageLines(_cuY, _cuY);
 
     // check if selection is still valid.
     checkSelection(_lastPos, _lastPos);
@@ -1336,6 +1358,75 @@ notcombine:
     }
 }
 
+void Screen::displayString(const uint *chars, int count)
+{
+    while (count > 0) {
+        // Same wrapping rule as displayCharacter(), for a character of width 1
+        if (_cuX + 1 > getScreenLineColumns(_cuY)) {
+            if (getMode(MODE_Wrap)) {
+                _lineProperties[_cuY].flags.f.wrapped = 1;
+                nextLine();
+            } else {
+                _cuX = qMax(getScreenLineColumns(_cuY) - 1, 0);
+            }
+        }
+
+        const int n = qMin(count, qMax(getScreenLineColumns(_cuY) - _cuX, 1));
+
+        if (getMode(MODE_Insert)) {
+            if (_screenLines[_cuY].size() < _cuX + 1) {
+                _screenLines[_cuY].resize(_cuX + 1);
+            }
+            insertChars(n);
+        }
+
+        // ensure current line vector has enough elements
+        if (_screenLines[_cuY].size() < _cuX + n) {
+            _screenLines[_cuY].resize(_cuX + n);
+        }
+
+        _lastPos = loc(_cuX + n - 1, _cuY);
+        damageLines(_cuY, _cuY);
+
+        // check if selection is still valid.
+        checkSelection(loc(_cuX, _cuY), _lastPos);
+
+        const ExtraFlags flags = setRepl(EF_REAL, _replMode) | SetULColor(0, _currentULColor);
+        Character *line = _screenLines[_cuY].data() + _cuX;
+        for (int i = 0; i < n; ++i) {
+            const uint c = chars[i];
+            Character &currentChar = line[i];
+            currentChar.character = c;
+            currentChar.foregroundColor = _effectiveForeground;
+            currentChar.backgroundColor = _effectiveBackground;
+            currentChar.rendition = _effectiveRendition;
+            currentChar.flags = flags;
+            if (c > ' ') {
+                currentChar.flags |= EF_ASCII_WORD;
+            }
+        }
+
+        if (_escapeSequenceUrlExtractor) {
+            for (int i = 0; i < n; ++i) {
+                _escapeSequenceUrlExtractor->appendUrlText(chars[i]);
+            }
+        }
+
+        _lastDrawnChar = chars[n - 1];
+
+        _cuX += n;
+        if (_replMode != REPL_None && std::make_pair(_cuY, _cuX) >= _replModeEnd) {
+            _replModeEnd = std::make_pair(_cuY, _cuX);
+        }
+        if (_lineProperties[_cuY].length < _cuX) {
+            _lineProperties[_cuY].length = _cuX;
+        }
+
+        chars += n;
+        count -= n;
+    }
+}
+
 int Screen::scrolledLines() const
 {
     return _scrolledLines;
@@ -1490,6 +1581,7 @@ void Screen::clearImage(int loca, int loce, char c, bool resetLineRendition)
 
     const int topLine = loca / _columns;
     const int bottomLine = loce / _columns;
+    damageLines(topLine, bottomLine);
 
     // When readline shortens text, it uses clearImage() to remove the extraneous text
     if (_replMode != REPL_None && std::make_pair(topLine, loca % _columns) <= _replModeEnd) {
@@ -1557,6 +1649,7 @@ void Screen::moveImage(int dest, int sourceBegin, int sourceEnd)
     //(search the web for 'memmove implementation' for details)
     const int destY = dest / _columns;
     const int srcY = sourceBegin / _columns;
+    damageLines(qMin(destY, srcY), qMax(destY, srcY) + lines);
     if (dest < sourceBegin) {
         /**
          * This is basically a left rotate.
@@ -1593,6 +1686,7 @@ void Screen::moveImage(int dest, int sourceBegin, int sourceEnd)
 
     // Adjust selection to follow scroll.
     if (_selBegin != -1) {
+        damageAll();
         const bool beginIsTL = (_selBegin == _selTopLeft);
         const int diff = dest - sourceBegin; // Scroll by this amount
         const int scr_TL = loc(0, _history->getLines());
@@ -1750,6 +1844,9 @@ void Screen::setULColor(int space, int color)
 
 void Screen::clearSelection()
 {
+    if (_selBegin != -1 || _selTopLeft != -1) {
+        damageAll();
+    }
     _selBottomRight = -1;
     _selTopLeft = -1;
     _selBegin = -1;
@@ -1782,6 +1879,7 @@ void Screen::getSelectionEnd(int &column, int &line) const
 }
 void Screen::setSelectionStart(const int x, const int y, const bool blockSelectionMode)
 {
+    damageAll();
     _selBegin = loc(x, y);
     /* FIXME, HACK to correct for x too far to the right... */
     if (x == _columns) {
@@ -1799,6 +1897,7 @@ void Screen::setSelectionEnd(const int x, const int y, const bool trimTrailingWh
         return;
     }
 
+    damageAll();
     int endPos = loc(x, y);
 
     if (endPos < _selBegin) {
@@ -2343,8 +2442,35 @@ void Screen::writeLinesToStream(TerminalCharacterDecoder *decoder, int fromLine,
     writeToStream(decoder, loc(0, fromLine), loc(_columns - 1, toLine), PreserveLineBreaks);
 }
 
+void Screen::setSearchIndexEnabled(bool enable)
+{
+    _history->setSearchIndexEnabled(enable);
+}
+
+bool Screen::isSearchIndexEnabled() const
+{
+    return _history->isSearchIndexEnabled();
+}
+
+bool Screen::searchCandidates(const QString &literal, QVector<std::pair<int, int>> *ranges)
+{
+    if (!_history->searchCandidates(literal, ranges)) {
+        return false;
+    }
+
+    // the screen changes too often to be worth indexing
+    ranges->append({_history->getLines(), _history->getLines() + _lines - 1});
+    return true;
+}
+
+bool Screen::buildSearchIndex(int maxLines)
+{
+    return _history->buildSearchIndex(maxLines);
+}
+
 void Screen::fastAddHistLine()
 {
+    damageAll();
     const bool removeLine = _history->getLines() == _history->getMaxLines();
     _history->addCellsVector(_screenLines.at(0));
     _history->addLine(linePropertiesAt(0));
@@ -2375,6 +2501,8 @@ void Screen::addHistLine()
     int newHistLines = _history->getLines();
 
     if (hasScroll()) {
+        // the lines of the history move up in every window which doesn't follow the output
+        damageAll();
         _history->addCellsVector(_screenLines.at(0));
         _history->addLine(_lineProperties.at(0));
 
@@ -2385,7 +2513,9 @@ void Screen::addHistLine()
         if (newHistLines <= oldHistLines) {
             _droppedLines += oldHistLines - newHistLines + 1;
 
-            currentTerminalDisplay()->removeLines(oldHistLines - newHistLines + 1);
+            if (currentTerminalDisplay()) {
+                currentTerminalDisplay()->removeLines(oldHistLines - newHistLines + 1);
+            }
             // We removed some lines, we need to verify if we need to remove a URL.
             if (_escapeSequenceUrlExtractor) {
                 _escapeSequenceUrlExtractor->historyLinesRemoved(oldHistLines - newHistLines + 1);
@@ -2439,16 +2569,21 @@ int Screen::getHistLines() const
 void Screen::setScroll(const HistoryType &t, bool copyPreviousScroll)
 {
     clearSelection();
+    damageAll();
 
+    const bool searchIndexEnabled = _history->isSearchIndexEnabled();
     if (copyPreviousScroll) {
         t.scroll(_history);
     } else {
         // As 't' can be '_history' pointer, move it to a temporary smart pointer
         // making _history = nullptr
         auto oldHistory = std::move(_history);
-        currentTerminalDisplay()->removeLines(oldHistory->getLines());
+        if (currentTerminalDisplay()) {
+            currentTerminalDisplay()->removeLines(oldHistory->getLines());
+        }
         t.scroll(_history);
     }
+    _history->setSearchIndexEnabled(searchIndexEnabled);
     _graphicsPlacements.clear();
 #if HAVE_MALLOC_TRIM
 
@@ -2471,6 +2606,7 @@ const HistoryType &Screen::getScroll() const
 
 void Screen::setLineProperty(quint16 property, bool enable)
 {
+    damageLines(_cuY, _cuY);
     if (enable) {
         _lineProperties[_cuY].flags.all |= property;
     } else {
@@ -2493,6 +2629,7 @@ void Screen::setReplMode(int mode)
             _replLastOutputStart = _replModeStart;
             _replLastOutputEnd = _replModeEnd;
         } else if (_replMode == REPL_PROMPT) {
+            damageLines(_cuY, _cuY);
             _lineProperties[_cuY].counter = ++commandCounter;
         }
         if (mode == REPL_PROMPT) {
@@ -2520,6 +2657,8 @@ void Screen::setReplMode(int mode)
 
 void Screen::setExitCode(int exitCode)
 {
+    // this also changes the lines in the history
+    damageAll();
     int y = _cuY - 1;
     while (y >= 0) {
         _lineProperties[y].flags.f.error = (exitCode != 0);
@@ -2538,6 +2677,38 @@ void Screen::setExitCode(int exitCode)
         y--;
     }
 }
+quint64 Screen::damageStamp() const
+{
+    return _damageStamp;
+}
+
+bool Screen::isFullyDamagedSince(quint64 stamp) const
+{
+    return _fullDamageStamp > stamp;
+}
+
+bool Screen::isLineDamagedSince(int line, quint64 stamp) const
+{
+    return _fullDamageStamp > stamp || line < 0 || line >= int(_lineDamageStamps.size()) || _lineDamageStamps[line] > stamp;
+}
+
+void Screen::damageLines(int first, int last)
+{
+    first = qMax(first, 0);
+    last = qMin(last, int(_lineDamageStamps.size()) - 1);
+    if (first > last) {
+        return;
+    }
+
+    ++_damageStamp;
+    std::fill(_lineDamageStamps.begin() + first, _lineDamageStamps.begin() + last + 1, _damageStamp);
+}
+
+void Screen::damageAll()
+{
+    _fullDamageStamp = ++_damageStamp;
+}
+
 void Screen::fillWithDefaultChar(Character *dest, int count)
 {
     std::fill_n(dest, count, Screen::DefaultChar);
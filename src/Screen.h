@@ -10,6 +10,7 @@
 
 // STD
 #include <memory>
+#include <utility>
 
 // Qt
 #include <QBitArray>
@@ -407,6 +408,16 @@ public:
      */
     void displayCharacter(uint c);
 
+    /**
+     * Displays a run of @p count printable ASCII characters (0x20..0x7E) starting
+     * at the current cursor position.
+     *
+     * The result is identical to calling displayCharacter() for each character,
+     * but wrapping, insert mode and selection checks are handled once per
+     * stretch of the line instead of once per character.
+     */
+    void displayString(const uint *chars, int count);
+
     /**
      * Resizes the image to a new fixed size of @p new_lines by @p new_columns.
      * In the case that @p new_columns is smaller than the current number of columns,
@@ -537,6 +548,32 @@ public:
      */
     void writeLinesToStream(TerminalCharacterDecoder *decoder, int fromLine, int toLine) const;
 
+    /**
+     * Enables or disables the search index of the history.  Disabling it
+     * frees the index.  The setting is kept when the history type changes.
+     */
+    void setSearchIndexEnabled(bool enable);
+    /** Returns true if the search index of the history is enabled.  See setSearchIndexEnabled() */
+    bool isSearchIndexEnabled() const;
+
+    /**
+     * Stores the ranges of lines which may contain @p literal in @p ranges,
+     * as pairs of first and last line numbers.  The lines on the screen are
+     * always included.  The lines added to the history since the last call
+     * are indexed first.
+     *
+     * Returns false if the search index is disabled or can't narrow down
+     * the lines, in which case all of them have to be searched.
+     */
+    bool searchCandidates(const QString &literal, QVector<std::pair<int, int>> *ranges);
+
+    /**
+     * Indexes at most @p maxLines lines of the history, so that a large
+     * history can be indexed over several calls.  Returns true once
+     * searchCandidates() no longer has lines to index.
+     */
+    bool buildSearchIndex(int maxLines);
+
     /**
      * Checks if the text between from and to is inside the current
      * selection. If this is the case, the selection is cleared. The
@@ -644,6 +681,26 @@ public:
      */
     void resetDroppedLines();
 
+    /**
+     * Returns a counter which is increased by every change to the image of the screen.
+     * A view which remembers it when taking a copy of the image can later ask with
+     * isLineDamagedSince() which lines it needs to copy again.
+     */
+    quint64 damageStamp() const;
+
+    /**
+     * Returns true if more than the content of single screen lines changed since
+     * damageStamp() returned @p stamp, e.g. the history, the selection or the size.
+     */
+    bool isFullyDamagedSince(quint64 stamp) const;
+
+    /**
+     * Returns true if the screen line @p line, where 0 is the first line of the screen
+     * rather than of the history, may have changed since damageStamp() returned @p stamp.
+     * Changes to the position of the cursor are not tracked.
+     */
+    bool isLineDamagedSince(int line, quint64 stamp) const;
+
     /**
      * Fills the buffer @p dest with @p count instances of the default (ie. blank)
      * Character style.
@@ -796,6 +853,11 @@ private:
     // taking DECDWL/DECDHL (double width/height modes) into account.
     int getScreenLineColumns(const int line) const;
 
+    // records that the screen lines first to last changed
+    void damageLines(int first, int last);
+    // records that more than single screen lines changed
+    void damageAll();
+
     // screen image ----------------
     int _lines;
     int _columns;
@@ -815,6 +877,12 @@ private:
     bool _enableReflowLines;
 
     std::vector<LineProperty> _lineProperties;
+
+    // damage tracking: the value of _damageStamp when each screen line last
+    // changed, and when anything else changed
+    quint64 _damageStamp = 0;
+    quint64 _fullDamageStamp = 0;
+    std::vector<quint64> _lineDamageStamps;
     LineProperty linePropertiesAt(unsigned int line);
 
     // history buffer ---------------
@@ -57,23 +57,67 @@ Character *ScreenWindow::getImage()
         _windowBufferSize = size;
         _windowBuffer = new Character[size];
         _bufferNeedsUpdate = true;
+        _bufferScreen = nullptr;
     }
 
     if (!_bufferNeedsUpdate) {
         return _windowBuffer;
     }
 
-    _screen->getImage(_windowBuffer, size, currentLine(), endWindowLine());
+    const int startLine = currentLine();
+    const int histLines = _screen->getHistLines();
+    const QPoint cursor = cursorPosition();
+    const bool cursorVisible = _screen->getMode(MODE_Cursor);
 
-    // this window may look beyond the end of the screen, in which
-    // case there will be an unused area which needs to be filled
-    // with blank characters
-    fillUnusedArea();
+    if (_changedLines.size() != windowLines()) {
+        _changedLines.fill(true, windowLines());
+        _bufferScreen = nullptr;
+    }
+
+    // the lines of the history only change when lines are added to it, so unless the
+    // window moved, only the screen lines which changed have to be copied again
+    if (_bufferScreen != _screen || startLine != _bufferCurrentLine || histLines != _bufferHistLines || _screen->isFullyDamagedSince(_bufferDamageStamp)
+        || _screen->getMode(MODE_SelectCursor)) {
+        _screen->getImage(_windowBuffer, size, startLine, endWindowLine());
+
+        // this window may look beyond the end of the screen, in which
+        // case there will be an unused area which needs to be filled
+        // with blank characters
+        fillUnusedArea();
+
+        _changedLines.fill(true);
+    } else {
+        const int columns = windowColumns();
+        const bool cursorChanged = cursor != _bufferCursor || cursorVisible != _bufferCursorVisible;
+        const int lines = qMin(windowLines(), endWindowLine() - startLine + 1);
+        for (int y = qMax(0, histLines - startLine); y < lines; ++y) {
+            const int screenLine = startLine + y - histLines;
+            if (_screen->isLineDamagedSince(screenLine, _bufferDamageStamp)
+                || (cursorChanged && (screenLine == cursor.y() || screenLine == _bufferCursor.y()))) {
+                _screen->getImage(_windowBuffer + y * columns, columns, startLine + y, startLine + y);
+                _changedLines[y] = true;
+            }
+        }
+    }
+
+    _bufferScreen = _screen;
+    _bufferDamageStamp = _screen->damageStamp();
+    _bufferCurrentLine = startLine;
+    _bufferHistLines = histLines;
+    _bufferCursor = cursor;
+    _bufferCursorVisible = cursorVisible;
 
     _bufferNeedsUpdate = false;
     return _windowBuffer;
 }
 
+QVector<bool> ScreenWindow::takeChangedLines()
+{
+    QVector<bool> changedLines = _changedLines;
+    _changedLines.fill(false);
+    return changedLines;
+}
+
 void ScreenWindow::fillUnusedArea()
 {
     int screenEndLine = _screen->getHistLines() + _screen->getLines() - 1;
@@ -67,6 +67,15 @@ public:
      */
     Character *getImage();
 
+    /**
+     * Returns which lines of the image returned by getImage() have changed since the
+     * last call to this method, with one entry for each line of the window.
+     *
+     * getImage() only copies the lines which changed on the screen, unless the window
+     * was scrolled or resized, or something else which affects every line changed.
+     */
+    QVector<bool> takeChangedLines();
+
     /**
      * Returns the line attributes associated with the lines of characters which
      * are currently visible through this window
@@ -267,6 +276,17 @@ private:
     int _windowBufferSize;
     bool _bufferNeedsUpdate;
 
+    // the state of the screen when _windowBuffer was last updated, used to find
+    // out which of its lines need to be copied again
+    Screen *_bufferScreen = nullptr;
+    quint64 _bufferDamageStamp = 0;
+    int _bufferCurrentLine = 0;
+    int _bufferHistLines = 0;
+    QPoint _bufferCursor;
+    bool _bufferCursorVisible = false;
+    // lines of _windowBuffer which changed since takeChangedLines()
+    QVector<bool> _changedLines;
+
     int _windowLines;
     int _currentLine; // see scrollTo() , currentLine()
     int _currentResultLine;
@@ -7,12 +7,44 @@
 
 #include "SearchHistoryTask.h"
 
-#include <QApplication>
 #include <QTextStream>
 
+#include <algorithm>
+#include <iterator>
+
 #include "../decoders/PlainTextDecoder.h"
 #include "Emulation.h"
 
+namespace
+{
+// Number of lines decoded and searched at a time.  This bounds the memory used
+// for the decoded text and how long the worker may run after cancel().
+constexpr int BLOCK_LINES = 10000;
+// Number of blocks decoded ahead of the worker thread
+constexpr int MAX_QUEUED_BLOCKS = 2;
+
+// Returns the lines which are in both a and b, given as sorted and disjoint ranges
+QVector<std::pair<int, int>> intersectLines(const QVector<std::pair<int, int>> &a, const QVector<std::pair<int, int>> &b)
+{
+    QVector<std::pair<int, int>> lines;
+    auto itA = a.cbegin();
+    auto itB = b.cbegin();
+    while (itA != a.cend() && itB != b.cend()) {
+        const int first = qMax(itA->first, itB->first);
+        const int last = qMin(itA->second, itB->second);
+        if (first <= last) {
+            lines.append({first, last});
+        }
+        if (itA->second < itB->second) {
+            ++itA;
+        } else {
+            ++itB;
+        }
+    }
+    return lines;
+}
+}
+
 namespace Konsole
 {
 void SearchHistoryTask::addScreenWindow(Session *session, ScreenWindow *searchWindow)
@@ -22,29 +54,44 @@ void SearchHistoryTask::addScreenWindow(Session *session, ScreenWindow *searchWi
 
 bool SearchHistoryTask::execute()
 {
-    auto iter = QMapIterator<QPointer<Session>, ScreenWindowPtr>(_windows);
+    _pendingSessions = _windows.keys();
+    startNextWindow();
+    return true;
+}
 
-    while (iter.hasNext()) {
-        iter.next();
-        executeOnScreenWindow(iter.key(), iter.value());
+void SearchHistoryTask::cancel()
+{
+    if (_cancelled) {
+        return;
     }
 
+    _cancelled = true;
+    _searchPool.clear();
+    _ranges.clear();
+    _pendingSessions.clear();
+
     if (autoDelete()) {
         deleteLater();
     }
-    return true;
 }
 
-void SearchHistoryTask::executeOnScreenWindow(const QPointer<Session> &session, const ScreenWindowPtr &window)
+void SearchHistoryTask::startNextWindow()
 {
-    Q_ASSERT(session);
-    Q_ASSERT(window);
+    while (!_cancelled && !_pendingSessions.isEmpty()) {
+        _session = _pendingSessions.takeFirst();
+        _window = _windows.value(_session);
 
-    Emulation *emulation = session->emulation();
+        Q_ASSERT(_session);
+        Q_ASSERT(_window);
 
-    if (!_regExp.pattern().isEmpty()) {
-        bool forwards = (_direction == Enum::ForwardsSearch);
-        const int lastLine = window->lineCount() - 1;
+        if (_regExp.pattern().isEmpty()) {
+            Q_EMIT completed(false);
+            continue;
+        }
+
+        const bool forwards = (_direction == Enum::ForwardsSearch);
+        _lineCount = _window->lineCount();
+        const int lastLine = _lineCount - 1;
 
         int startLine = _startLine;
         if (forwards && (_startLine == lastLine)) {
@@ -58,153 +105,322 @@ void SearchHistoryTask::executeOnScreenWindow(const QPointer<Session> &session,
         } else {
             startLine = _startLine + (forwards ? 1 : -1);
         }
+        startLine = qBound(0, startLine, qMax(0, lastLine));
+
+        // search from the start line to the end of the output in the search direction,
+        // then through the rest of it: from the other end when wrapping, or back from
+        // the start line if noWrap is set
+        _ranges.clear();
+        if (forwards) {
+            _ranges.append({startLine, lastLine, true});
+            if (startLine > 0) {
+                _ranges.append({0, startLine - 1, !_noWrap});
+            }
+        } else {
+            _ranges.append({0, startLine, false});
+            if (startLine < lastLine) {
+                _ranges.append({startLine + 1, lastLine, _noWrap});
+            }
+        }
 
-        QString string;
+        _prefilter = LiteralPrefilter(_regExp);
+        _candidateLines = candidateLines(_session, _prefilter, _lineCount);
+        if (_restrictedLines) {
+            _candidateLines = intersectLines(_candidateLines, *_restrictedLines);
+        }
 
-        // text stream to read history into string for pattern or regular expression searching
-        QTextStream searchStream(&string);
+        // the blocks are decoded over many turns of the event loop, while the output changes
+        _screen = _window->screen();
+        _droppedLines = _session->emulation()->droppedLineCount();
+        _historyChanged = false;
+        disconnect(_historyConnection);
+        _historyConnection = connect(_session->emulation(), &Emulation::historyChanged, this, [this]() {
+            _historyChanged = true;
+        });
+
+        _resultFound = false;
+        queueBlocks();
+        return;
+    }
 
-        PlainTextDecoder decoder;
-        decoder.setRecordLinePositions(true);
+    disconnect(_historyConnection);
+    if (!_cancelled) {
+        Q_EMIT finished();
+        if (autoDelete()) {
+            deleteLater();
+        }
+    }
+}
 
-        // setup first and last lines depending on search direction
-        int line = startLine;
+QVector<std::pair<int, int>> SearchHistoryTask::candidateLines(Session *session, const LiteralPrefilter &prefilter, int lineCount)
+{
+    // when every match contains one of a few literals, the search index of
+    // the history can rule out most of the lines without decoding them
+    bool narrowed = prefilter.canFilter();
+    QVector<std::pair<int, int>> candidates;
+    const QStringList literals = prefilter.literals();
+    for (const QString &literal : literals) {
+        QVector<std::pair<int, int>> ranges;
+        if (!narrowed || !session->emulation()->searchCandidates(literal, &ranges)) {
+            narrowed = false;
+            break;
+        }
+        candidates.append(ranges);
+    }
 
-        // read through and search history in blocks of 10K lines.
-        // this balances the need to retrieve lots of data from the history each time
-        //(for efficient searching)
-        // without using silly amounts of memory if the history is very large.
-        const int maxDelta = qMin(window->lineCount(), 10000);
-        int delta = forwards ? maxDelta : -maxDelta;
+    if (!narrowed) {
+        return {{0, lineCount - 1}};
+    }
 
-        int endLine = line;
-        bool continueLoop = true;
-        bool invertDirection = false;
-        bool hasWrapped = false; // set to true when we reach the top/bottom
-        // of the output and continue from the other
-        // end
+    std::sort(candidates.begin(), candidates.end());
+    QVector<std::pair<int, int>> merged;
+    for (const auto &range : std::as_const(candidates)) {
+        if (range.first >= lineCount) {
+            break;
+        }
+        if (!merged.isEmpty() && merged.last().second + 1 >= range.first) {
+            merged.last().second = qMax(merged.last().second, range.second);
+        } else {
+            merged.append(range);
+        }
+        merged.last().second = qMin(merged.last().second, lineCount - 1);
+    }
+    return merged;
+}
 
-        QSet<int> matchPositions;
+QVector<std::pair<int, int>> SearchHistoryTask::linesAround(const QList<int> &lines, int offset, int length, int columns)
+{
+    // a match starts on an earlier line than the part found before if the text in
+    // front of that part wraps into it, and runs on past that line if the rest of the
+    // text wraps.  Each character takes up to two columns.
+    const int linesBefore = (2 * offset + columns - 1) / columns;
+    const int linesAfter = (2 * (length - offset) + columns - 1) / columns;
+
+    QVector<std::pair<int, int>> ranges;
+    for (const int line : lines) {
+        const int first = qMax(0, line - linesBefore);
+        const int last = line + linesAfter;
+        if (!ranges.isEmpty() && ranges.last().second + 1 >= first) {
+            ranges.last().second = qMax(ranges.last().second, last);
+        } else {
+            ranges.append({first, last});
+        }
+    }
+    return ranges;
+}
 
-        decoder.begin(&searchStream);
-        emulation->writeToStream(&decoder, 0, lastLine);
-        decoder.end();
-        const QList<int> linePositions = decoder.linePositions();
+SearchHistoryTask::Segment SearchHistoryTask::decodeLines(Session *session, int firstLine, int lastLine)
+{
+    Segment segment;
+    segment.firstLine = firstLine;
+    segment.lastLine = lastLine;
+    QTextStream searchStream(&segment.text);
+    PlainTextDecoder decoder;
+    decoder.setRecordLinePositions(true);
+    decoder.begin(&searchStream);
+    session->emulation()->writeToStream(&decoder, firstLine, lastLine);
+    decoder.end();
+    segment.linePositions = decoder.linePositions();
+    return segment;
+}
 
-        QRegularExpressionMatchIterator matchIterator = _regExp.globalMatch(string);
-        while (matchIterator.hasNext()) {
+QList<int>
+SearchHistoryTask::matchLines(const Segment &segment, const QRegularExpression &regExp, const LiteralPrefilter &prefilter, const std::atomic<bool> &cancelled)
+{
+    QList<int> matchLines;
+
+    // only the lines containing one of the required literals can match
+    const QList<LiteralPrefilter::Span> spans = prefilter.candidateSpans(segment.text);
+    for (const auto &[spanStart, spanLength] : spans) {
+        QRegularExpressionMatchIterator matchIterator = regExp.globalMatchView(QStringView(segment.text).mid(spanStart, spanLength));
+        while (matchIterator.hasNext() && !cancelled) {
             const QRegularExpressionMatch match = matchIterator.next();
-            const qsizetype startPos = match.capturedStart();
-            if (startPos != -1) {
-                const auto lineMatch = std::upper_bound(linePositions.begin(), linePositions.end(), startPos);
-                if (lineMatch != linePositions.end()) {
-                    const auto lineIdx = qMin(0ll, lastLine) + std::distance(linePositions.begin(), lineMatch) - 1;
-                    matchPositions.insert(static_cast<int>(lineIdx));
-                }
+            if (match.capturedStart() == -1) {
+                continue;
+            }
+            const qsizetype startPos = spanStart + match.capturedStart();
+            const auto lineMatch = std::upper_bound(segment.linePositions.begin(), segment.linePositions.end(), startPos);
+            const int line = qMin(segment.lastLine, segment.firstLine + static_cast<int>(std::distance(segment.linePositions.begin(), lineMatch)) - 1);
+            if (matchLines.isEmpty() || matchLines.last() != line) {
+                matchLines.append(line);
             }
         }
+    }
 
-        Q_EMIT searchResults(matchPositions, window->lineCount());
+    return matchLines;
+}
 
-        string.clear();
+bool SearchHistoryTask::followOutput()
+{
+    if (_session.isNull() || _window.isNull() || _historyChanged || _window->screen() != _screen) {
+        return false;
+    }
 
-        // loop through history in blocks of <delta> lines.
-        do {
-            // ensure that application does not appear to hang
-            // if searching through a lengthy output
-            QApplication::processEvents();
+    // lines dropped from the top of the output, as by Clear Scrollback or a full
+    // history, move the others up
+    const int droppedLines = int(_session->emulation()->droppedLineCount() - _droppedLines);
+    _droppedLines += droppedLines;
+    _lineCount = _window->lineCount();
+    const int lastLine = _lineCount - 1;
+
+    for (auto range = _ranges.begin(); range != _ranges.end();) {
+        range->first = qMax(0, range->first - droppedLines);
+        range->last = qMin(lastLine, range->last - droppedLines);
+        if (range->first > range->last) {
+            range = _ranges.erase(range);
+        } else {
+            ++range;
+        }
+    }
 
-            // calculate lines to search in this iteration
-            if (hasWrapped) {
-                if (endLine == lastLine) {
-                    line = 0;
-                } else if (endLine == 0) {
-                    line = lastLine;
-                }
+    if (droppedLines > 0) {
+        QVector<std::pair<int, int>> candidates;
+        for (const auto &[first, last] : std::as_const(_candidateLines)) {
+            if (last - droppedLines >= 0) {
+                candidates.append({qMax(0, first - droppedLines), last - droppedLines});
+            }
+        }
+        _candidateLines = candidates;
+    }
+    return true;
+}
 
-                endLine += delta;
-
-                if (forwards) {
-                    if (endLine >= startLine) {
-                        endLine = startLine;
-                        continueLoop = false;
-                    }
-                } else {
-                    if (endLine <= startLine) {
-                        endLine = startLine;
-                        continueLoop = false;
-                    }
+void SearchHistoryTask::queueBlocks()
+{
+    if (!followOutput()) {
+        _ranges.clear();
+    }
+
+    const auto candidatesBegin = _candidateLines.cbegin();
+    const auto candidatesEnd = _candidateLines.cend();
+
+    while (_queuedBlocks < MAX_QUEUED_BLOCKS && !_ranges.isEmpty()) {
+        LineRange &range = _ranges.first();
+        const bool forwards = range.forwards;
+
+        // collect up to BLOCK_LINES candidate lines, nearest to the start line first
+        QVector<Segment> segments;
+        int lines = 0;
+        while (lines < BLOCK_LINES && range.first <= range.last) {
+            int firstLine;
+            int lastLine;
+            if (forwards) {
+                const auto candidates = std::lower_bound(candidatesBegin, candidatesEnd, range.first, [](const std::pair<int, int> &candidates, int line) {
+                    return candidates.second < line;
+                });
+                if (candidates == candidatesEnd || candidates->first > range.last) {
+                    range.first = range.last + 1;
+                    break;
                 }
+                firstLine = qMax(range.first, candidates->first);
+                lastLine = qMin(qMin(range.last, candidates->second), firstLine + BLOCK_LINES - lines - 1);
+                range.first = lastLine + 1;
             } else {
-                endLine += delta;
-
-                if (endLine > lastLine) {
-                    hasWrapped = true;
-                    endLine = lastLine;
-                } else if (endLine < 0) {
-                    hasWrapped = true;
-                    endLine = 0;
+                auto candidates = std::upper_bound(candidatesBegin, candidatesEnd, range.last, [](int line, const std::pair<int, int> &candidates) {
+                    return line < candidates.first;
+                });
+                if (candidates == candidatesBegin || std::prev(candidates)->second < range.first) {
+                    range.last = range.first - 1;
+                    break;
                 }
+                --candidates;
+                lastLine = qMin(range.last, candidates->second);
+                firstLine = qMax(qMax(range.first, candidates->first), lastLine - (BLOCK_LINES - lines) + 1);
+                range.last = firstLine - 1;
             }
 
-            decoder.begin(&searchStream);
-            emulation->writeToStream(&decoder, qMin(endLine, line), qMax(endLine, line));
-            decoder.end();
-
-            // line number search below assumes that the buffer ends with a new-line
-            string.append(QLatin1Char('\n'));
+            // the history and screen belong to the GUI thread, so the text is decoded
+            // here and only the matching runs on the worker
+            segments.append(decodeLines(_session, firstLine, lastLine));
+            lines += lastLine - firstLine + 1;
+        }
+        if (range.first > range.last) {
+            _ranges.removeFirst();
+        }
+        if (segments.isEmpty()) {
+            continue;
+        }
 
-            const auto pos = forwards ? string.indexOf(_regExp) : string.lastIndexOf(_regExp);
+        ++_queuedBlocks;
+        _searchPool.start([this, regExp = _regExp, prefilter = _prefilter, segments, forwards, droppedLines = _droppedLines]() {
+            QList<int> matchLines;
+            for (const Segment &segment : segments) {
+                matchLines.append(SearchHistoryTask::matchLines(segment, regExp, prefilter, _cancelled));
+            }
 
-            // if a match is found, position the cursor on that line and update the screen
-            if (pos != -1) {
-                int newLines = 0;
-                QList<int> linePositions = decoder.linePositions();
-                while (newLines < linePositions.count() && linePositions[newLines] <= pos) {
-                    newLines++;
-                }
+            if (!_cancelled) {
+                QMetaObject::invokeMethod(
+                    this,
+                    [this, forwards, matchLines, droppedLines]() {
+                        blockSearched(forwards, matchLines, droppedLines);
+                    },
+                    Qt::QueuedConnection);
+            }
+        });
+    }
+}
 
-                // ignore the new line at the start of the buffer
-                newLines--;
+void SearchHistoryTask::blockSearched(bool forwards, const QList<int> &blockLines, qint64 droppedLines)
+{
+    --_queuedBlocks;
+    if (_cancelled) {
+        return;
+    }
 
-                int findPos = qMin(line, endLine) + newLines;
+    // the lines were numbered when the block was decoded, and the output may
+    // have changed since then
+    QList<int> matchLines;
+    if (followOutput()) {
+        const int shift = int(_droppedLines - droppedLines);
+        for (const int line : blockLines) {
+            if (line - shift >= 0 && line - shift < _lineCount) {
+                matchLines.append(line - shift);
+            }
+        }
+    } else {
+        _ranges.clear();
+    }
 
-                highlightResult(window, findPos);
+    if (!matchLines.isEmpty()) {
+        // blocks complete in search order, so the first block with a match
+        // holds the result nearest to the start line
+        if (!_resultFound) {
+            _resultFound = true;
+            const auto [first, last] = std::minmax_element(matchLines.cbegin(), matchLines.cend());
+            highlightResult(_window, forwards ? *first : *last);
+            Q_EMIT completed(true);
+        }
 
-                Q_EMIT completed(true);
+        // the remaining blocks are still searched so that all matches are reported
+        Q_EMIT searchResults(matchLines, _lineCount);
 
-                return;
-            }
+        if (_cancelled) {
+            return;
+        }
+    }
 
-            // if noWrap is checked and we wrapped, set cursor at last match
-            if (hasWrapped && _noWrap) {
-                // one chance to invert search direction
-                if (invertDirection) {
-                    continueLoop = false;
-                }
-                invertDirection = true;
-                forwards = !forwards;
-                delta = -delta;
-                endLine += (forwards ? 1 : -1);
-                hasWrapped = false;
-            }
+    queueBlocks();
+    if (_queuedBlocks == 0) {
+        finishWindow();
+    }
+}
 
-            // clear the current block of text and move to the next one
-            string.clear();
-            line = endLine;
-        } while (continueLoop);
-        if (!session->getSelectMode()) {
+void SearchHistoryTask::finishWindow()
+{
+    if (!_resultFound && !_session.isNull() && !_window.isNull()) {
+        if (!_session->getSelectMode()) {
             // if no match was found, clear selection to indicate this,
-            window->clearSelection();
-            window->notifyOutputChanged();
-
-            Q_EMIT searchResults(QSet<int>{}, window->lineCount());
+            _window->clearSelection();
+            _window->notifyOutputChanged();
         }
+
+        Q_EMIT completed(false);
     }
 
-    Q_EMIT completed(false);
+    startNextWindow();
 }
-void SearchHistoryTask::highlightResult(const ScreenWindowPtr &window, int findPos)
+
+void SearchHistoryTask::highlightResult(ScreenWindow *window, int findPos)
 {
     // work out how many lines into the current block of text the search result was found
     //- looks a little painful, but it only has to be done once per search.
@@ -232,6 +448,15 @@ SearchHistoryTask::SearchHistoryTask(QObject *parent)
     , _noWrap(false)
     , _startLine(0)
 {
+    _searchPool.setMaxThreadCount(1);
+}
+
+SearchHistoryTask::~SearchHistoryTask()
+{
+    // the worker refers to this task, so it has to finish first
+    _cancelled = true;
+    _searchPool.clear();
+    _searchPool.waitForDone();
 }
 
 void SearchHistoryTask::setSearchDirection(Enum::SearchDirection direction)
@@ -239,6 +464,11 @@ void SearchHistoryTask::setSearchDirection(Enum::SearchDirection direction)
     _direction = direction;
 }
 
+void SearchHistoryTask::setCandidateLines(const QVector<std::pair<int, int>> &lines)
+{
+    _restrictedLines = lines;
+}
+
 void SearchHistoryTask::setStartLine(int line)
 {
     _startLine = line;
@@ -8,12 +8,20 @@
 #ifndef SEARCHHISTORYTASK_H
 #define SEARCHHISTORYTASK_H
 
+#include <QList>
 #include <QMap>
 #include <QPointer>
 #include <QRegularExpression>
+#include <QThreadPool>
+#include <QVector>
+
+#include <atomic>
+#include <optional>
+#include <utility>
 
 #include "Enumeration.h"
 #include "ScreenWindow.h"
+#include "filterHotSpots/LiteralPrefilter.h"
 #include "konsoleprivate_export.h"
 #include "session/Session.h"
 #include "session/SessionTask.h"
@@ -29,11 +37,18 @@ namespace Konsole
  * When execute() is called, the search begins in the direction specified by searchDirection(),
  * starting at the position of the current selection.
  *
+ * The output is decoded on the GUI thread in blocks of lines, which are matched against the
+ * regular expression on a worker thread.  The lines containing matches are reported through
+ * searchResults() as each block finishes, and the first match in the search direction is
+ * highlighted as soon as it is known.  A search in progress can be stopped with cancel().
+ *
+ * If every match of the pattern contains one of a few literals, the search index of the
+ * history is used to skip the lines which can't contain any of them, and the regular
+ * expression only runs on the lines which do.
+ *
  * FIXME - This is not a proper implementation of SessionTask, in that it ignores sessions specified
  * with addSession()
  *
- * TODO - Implementation requirements:
- *          May provide progress feedback to the user when searching very large output logs.
  */
 class KONSOLEPRIVATE_EXPORT SearchHistoryTask : public SessionTask
 {
@@ -44,6 +59,7 @@ public:
      * Constructs a new search task.
      */
     explicit SearchHistoryTask(QObject *parent = nullptr);
+    ~SearchHistoryTask() override;
 
     /** Adds a screen window to the list to search when execute() is called. */
     void addScreenWindow(Session *session, ScreenWindow *searchWindow);
@@ -66,32 +82,130 @@ public:
     /** The line from which the search will be done **/
     void setStartLine(int line);
 
+    /**
+     * Restricts the search to the given ranges of lines, as pairs of first and last
+     * line numbers in ascending order.  This is used to search only the lines which
+     * matched an earlier search that every match of the regular expression also matches.
+     */
+    void setCandidateLines(const QVector<std::pair<int, int>> &lines);
+
     /**
      * Performs a search through the session's history, starting at the position
      * of the current selection, in the direction specified by setSearchDirection().
      *
-     * If it finds a match, the ScreenWindow specified in the constructor is
-     * scrolled to the position where the match occurred and the selection
-     * is set to the matching text.  execute() then returns immediately.
+     * execute() returns immediately; the search continues in the background.
+     * If it finds a match, the ScreenWindow is scrolled to the position where
+     * the match occurred and completed(true) is emitted.  If the whole output
+     * was searched without a match, completed(false) is emitted.
      *
-     * To continue the search looking for further matches, call execute() again.
+     * To continue the search looking for further matches, start a new task.
      */
     bool execute() override;
 
+    /**
+     * Stops the search in progress.  No further signals are emitted, and the
+     * task deletes itself if autoDelete() is set.
+     */
+    void cancel();
+
+    /** Lines of the output of a session, decoded to be searched on a worker thread */
+    struct Segment {
+        int firstLine = 0;
+        int lastLine = 0;
+        QString text;
+        QList<int> linePositions;
+    };
+
+    /**
+     * Returns the ranges of lines, out of the first @p lineCount lines of the output of
+     * @p session, which may contain a match for the pattern of @p prefilter, as pairs of
+     * first and last line numbers in ascending order.
+     */
+    static QVector<std::pair<int, int>> candidateLines(Session *session, const LiteralPrefilter &prefilter, int lineCount);
+
+    /**
+     * Returns the ranges of lines, as pairs of first and last line numbers in ascending
+     * order, which can hold a match for a text of @p length characters, given the sorted
+     * @p lines on which matches for the part of it which starts @p offset characters in
+     * were found.  The text may wrap across lines of @p columns columns, and each of its
+     * characters may be double-width.
+     */
+    static QVector<std::pair<int, int>> linesAround(const QList<int> &lines, int offset, int length, int columns);
+
+    /** Decodes the lines @p firstLine to @p lastLine of the output of @p session */
+    static Segment decodeLines(Session *session, int firstLine, int lastLine);
+
+    /**
+     * Returns the lines of @p segment which contain a match for @p regExp, in ascending order.
+     * This may be called on any thread, and stops early when @p cancelled is set.
+     */
+    static QList<int>
+    matchLines(const Segment &segment, const QRegularExpression &regExp, const LiteralPrefilter &prefilter, const std::atomic<bool> &cancelled);
+
+    /** Scrolls @p window to show the line @p findPos and marks it as the current search result */
+    static void highlightResult(ScreenWindow *window, int findPos);
+
 private:
     using ScreenWindowPtr = QPointer<ScreenWindow>;
 
-    void executeOnScreenWindow(const QPointer<Session> &session, const ScreenWindowPtr &window);
-    void highlightResult(const ScreenWindowPtr &window, int findPos);
+    // A range of lines searched in one direction
+    struct LineRange {
+        int first;
+        int last;
+        bool forwards;
+    };
+
+    void startNextWindow();
+    // moves the lines left to search along with the output, which may have changed
+    // since the last turn; returns false if the output was replaced
+    bool followOutput();
+    void queueBlocks();
+    void blockSearched(bool forwards, const QList<int> &blockLines, qint64 droppedLines);
+    void finishWindow();
 
     QMap<QPointer<Session>, ScreenWindowPtr> _windows;
     QRegularExpression _regExp;
+    LiteralPrefilter _prefilter;
     Enum::SearchDirection _direction;
     bool _noWrap;
     int _startLine;
 
+    // state of the search in the current window
+    QList<QPointer<Session>> _pendingSessions;
+    QPointer<Session> _session;
+    ScreenWindowPtr _window;
+    QList<LineRange> _ranges;
+    // the lines which may contain a match, as pairs of first and last line numbers
+    QVector<std::pair<int, int>> _candidateLines;
+    // the lines given to setCandidateLines(), if any
+    std::optional<QVector<std::pair<int, int>>> _restrictedLines;
+    int _lineCount = 0;
+    int _queuedBlocks = 0;
+    bool _resultFound = false;
+    // the screen shown by the window, and the lines dropped from the top of
+    // the output, when the line numbers above were last updated
+    const Screen *_screen = nullptr;
+    qint64 _droppedLines = 0;
+    bool _historyChanged = false;
+    QMetaObject::Connection _historyConnection;
+
+    std::atomic<bool> _cancelled{false};
+    // runs the blocks in the order they were queued; must be the last member
+    QThreadPool _searchPool;
+
 Q_SIGNALS:
-    void searchResults(const QSet<int>&, int);
+    /**
+     * Emitted with the lines, out of @p lineCount lines of output, which contain
+     * matches in a block that was searched.  Each line is reported once.
+     */
+    void searchResults(const QList<int> &lines, int lineCount);
+
+    /**
+     * Emitted when the whole output of every screen window has been searched, after
+     * every match was reported through searchResults().  This is not emitted if the
+     * search is cancelled.
+     */
+    void finished();
 };
 
 }
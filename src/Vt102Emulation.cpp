@@ -11,6 +11,10 @@
 // Standard
 #include <cstdio>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 // Qt
 #include <QApplication>
 #include <QAudioOutput>
@@ -67,6 +71,31 @@ static const quint16 vt100_graphics[32] = {
 };
 /* clang-format on */
 
+/*
+   Returns the length of the run of printable ASCII characters (0x20..0x7E)
+   at the start of @p chars, scanning at most @p count code points.
+*/
+static int printableAsciiRun(const uint *chars, int count)
+{
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128i lower = _mm_set1_epi32(0x1F);
+    const __m128i upper = _mm_set1_epi32(0x7F);
+    for (; i + 4 <= count; i += 4) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(chars + i));
+        const __m128i inRange = _mm_and_si128(_mm_cmpgt_epi32(block, lower), _mm_cmplt_epi32(block, upper));
+        const int mask = _mm_movemask_ps(_mm_castsi128_ps(inRange));
+        if (mask != 0xF) {
+            return i + qCountTrailingZeroBits(uint(~mask));
+        }
+    }
+#endif
+    while (i < count && chars[i] >= 0x20 && chars[i] <= 0x7E) {
+        ++i;
+    }
+    return i;
+}
+
 enum XTERM_EXTENDED {
     URL_LINK = '8',
 };
@@ -737,9 +766,19 @@ void Vt102Emulation::apc_end()
 
 void Vt102Emulation::receiveChars(const QVector<uint> &chars)
 {
-    for (uint cc : chars) {
+    const uint *const data = chars.constData();
+    const int count = chars.size();
+    for (int i = 0; i < count; ++i) {
+        const uint cc = data[i];
         // early out for displayable characters
         if (_state == Ground && ((cc >= 0x20 && cc <= 0x7E) || cc >= 0xA0)) {
+            // plain ASCII needs no charset translation, so hand the whole run to the screen at once
+            if (cc <= 0x7E && !charsetMapsAscii()) {
+                const int run = printableAsciiRun(data + i, count - i);
+                _currentScreen->displayString(data + i, run);
+                i += run - 1;
+                continue;
+            }
             _currentScreen->displayCharacter(applyCharset(cc));
             continue;
         }
@@ -3327,6 +3366,11 @@ unsigned int Vt102Emulation::applyCharset(uint c)
     return c;
 }
 
+bool Vt102Emulation::charsetMapsAscii() const
+{
+    return CHARSET.graphic || CHARSET.pound;
+}
+
 /*
    "Charset" related part of the emulation state.
    This configures the VT100 charset filter.
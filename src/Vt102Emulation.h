@@ -110,6 +110,8 @@ private Q_SLOTS:
 
 private:
     unsigned int applyCharset(uint c);
+    // true if the current charset translates any printable ASCII character
+    bool charsetMapsAscii() const;
     void setCharset(int n, int cs);
     void useCharset(int n);
     void setAndUseCharset(int n, int cs);
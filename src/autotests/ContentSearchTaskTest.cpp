@@ -0,0 +1,176 @@
+/*
+    SPDX-FileCopyrightText: 2026 Konsole Plus contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+// Own
+#include "ContentSearchTaskTest.h"
+
+// Qt
+#include <QHash>
+#include <QSignalSpy>
+#include <QTest>
+
+// STD
+#include <memory>
+
+// Konsole
+#include "../Emulation.h"
+#include "../SearchHistoryTask.h"
+#include "../history/compact/CompactHistoryType.h"
+#include "../searchtabs/ContentSearchTask.h"
+#include "../session/Session.h"
+
+using namespace Konsole;
+
+namespace
+{
+// Writes @p count lines of output, replacing the lines numbered in @p marked
+void receiveLines(Session *session, int count, const QHash<int, QString> &marked = {})
+{
+    for (int i = 0; i < count; ++i) {
+        const QByteArray line = marked.value(i, QStringLiteral("output line %1").arg(i)).toUtf8() + "\r\n";
+        session->emulation()->receiveData(line.constData(), line.size());
+    }
+}
+
+// Returns the text of the line of @p session which @p result refers to
+QString resultLineText(Session *session, const ContentSearchTask::Result &result)
+{
+    const int line = int(result.line - session->emulation()->droppedLineCount());
+    if (line < 0) {
+        return QString();
+    }
+    return SearchHistoryTask::decodeLines(session, line, line).text.trimmed();
+}
+
+struct Found {
+    Session *session;
+    ContentSearchTask::Result result;
+};
+}
+
+void ContentSearchTaskTest::testSearchSessions()
+{
+    auto first = std::make_unique<Session>();
+    auto second = std::make_unique<Session>();
+    first->emulation()->setHistory(CompactHistoryType(1000));
+    second->emulation()->setHistory(CompactHistoryType(1000));
+
+    receiveLines(first.get(), 300, {{20, QStringLiteral("error: older")}, {250, QStringLiteral("error: newer")}});
+    receiveLines(second.get(), 300, {{100, QStringLiteral("error: other tab")}});
+
+    ContentSearchTask task;
+    task.addSession(first.get());
+    task.addSession(second.get());
+    task.setRegExp(QRegularExpression(QStringLiteral("error")));
+
+    QList<Found> found;
+    connect(&task, &ContentSearchTask::resultsFound, this, [&found](Session *session, const QList<ContentSearchTask::Result> &results) {
+        for (const ContentSearchTask::Result &result : results) {
+            found.append({session, result});
+        }
+    });
+    QSignalSpy completed(&task, &SessionTask::completed);
+    QVERIFY(task.execute());
+    QVERIFY(completed.wait());
+    QCOMPARE(completed.first().first().toBool(), true);
+
+    QList<ContentSearchTask::Result> firstResults;
+    QList<ContentSearchTask::Result> secondResults;
+    for (const Found &entry : std::as_const(found)) {
+        (entry.session == first.get() ? firstResults : secondResults).append(entry.result);
+    }
+
+    // the most recent lines of each session come first
+    QCOMPARE(firstResults.size(), 2);
+    QCOMPARE(firstResults.at(0).text, QStringLiteral("error: newer"));
+    QCOMPARE(firstResults.at(1).text, QStringLiteral("error: older"));
+    QVERIFY(firstResults.at(0).age < firstResults.at(1).age);
+    QCOMPARE(firstResults.at(0).age, 300 - 250);
+
+    QCOMPARE(secondResults.size(), 1);
+    QCOMPARE(secondResults.at(0).text, QStringLiteral("error: other tab"));
+
+    for (const ContentSearchTask::Result &result : std::as_const(firstResults)) {
+        QCOMPARE(resultLineText(first.get(), result), result.text);
+    }
+    QCOMPARE(resultLineText(second.get(), secondResults.at(0)), secondResults.at(0).text);
+}
+
+void ContentSearchTaskTest::testDroppedLines()
+{
+    auto session = std::make_unique<Session>();
+    session->emulation()->setHistory(CompactHistoryType(100));
+    receiveLines(session.get(), 300, {{50, QStringLiteral("error: dropped")}, {250, QStringLiteral("error: kept")}});
+    QVERIFY(session->emulation()->droppedLineCount() > 0);
+
+    ContentSearchTask task;
+    task.addSession(session.get());
+    task.setRegExp(QRegularExpression(QStringLiteral("error")));
+
+    QList<ContentSearchTask::Result> found;
+    connect(&task, &ContentSearchTask::resultsFound, this, [&found](Session *, const QList<ContentSearchTask::Result> &results) {
+        found.append(results);
+    });
+    QSignalSpy completed(&task, &SessionTask::completed);
+    QVERIFY(task.execute());
+
+    // more lines are dropped while the search runs
+    const qint64 droppedLines = session->emulation()->droppedLineCount();
+    receiveLines(session.get(), 30);
+    QVERIFY(session->emulation()->droppedLineCount() > droppedLines);
+
+    QVERIFY(completed.wait());
+    QCOMPARE(found.size(), 1);
+    QCOMPARE(found.at(0).text, QStringLiteral("error: kept"));
+    QCOMPARE(resultLineText(session.get(), found.at(0)), QStringLiteral("error: kept"));
+
+    // and after the search
+    receiveLines(session.get(), 10);
+    QCOMPARE(resultLineText(session.get(), found.at(0)), QStringLiteral("error: kept"));
+}
+
+void ContentSearchTaskTest::testSearchIndexReleased()
+{
+    auto searched = std::make_unique<Session>();
+    auto other = std::make_unique<Session>();
+    for (Session *session : {searched.get(), other.get()}) {
+        session->emulation()->setHistory(CompactHistoryType(1000));
+        session->emulation()->setSearchIndexAllowed(true);
+        receiveLines(session, 300, {{120, QStringLiteral("error: indexed")}});
+    }
+    // the search bar of this session keeps its index enabled
+    other->emulation()->setSearchIndexEnabled(true);
+
+    ContentSearchTask task;
+    task.addSession(searched.get());
+    task.addSession(other.get());
+    task.setRegExp(QRegularExpression(QStringLiteral("error")));
+
+    int resultCount = 0;
+    connect(&task, &ContentSearchTask::resultsFound, this, [&resultCount](Session *, const QList<ContentSearchTask::Result> &results) {
+        resultCount += results.size();
+    });
+    QSignalSpy completed(&task, &SessionTask::completed);
+    QVERIFY(task.execute());
+    QVERIFY(completed.wait());
+    QCOMPARE(resultCount, 2);
+
+    // only the index enabled for the search is freed
+    QVERIFY(!searched->emulation()->isSearchIndexEnabled());
+    QVERIFY(other->emulation()->isSearchIndexEnabled());
+
+    // and when it is cancelled
+    ContentSearchTask cancelled;
+    cancelled.addSession(searched.get());
+    cancelled.setRegExp(QRegularExpression(QStringLiteral("error")));
+    QVERIFY(cancelled.execute());
+    cancelled.cancel();
+    QVERIFY(!searched->emulation()->isSearchIndexEnabled());
+}
+
+QTEST_MAIN(ContentSearchTaskTest)
+
+#include "moc_ContentSearchTaskTest.cpp"
@@ -0,0 +1,26 @@
+/*
+    SPDX-FileCopyrightText: 2026 Konsole Plus contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef CONTENTSEARCHTASKTEST_H
+#define CONTENTSEARCHTASKTEST_H
+
+#include <QObject>
+
+namespace Konsole
+{
+class ContentSearchTaskTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testSearchSessions();
+    void testDroppedLines();
+    void testSearchIndexReleased();
+};
+
+}
+
+#endif // CONTENTSEARCHTASKTEST_H
@@ -9,6 +9,8 @@
 
 #include <QTest>
 
+#include <algorithm>
+
 // Konsole
 #include "../Emulation.h"
 #include "../session/Session.h"
@@ -172,6 +174,213 @@ void HistoryTest::testHistoryReflow()
     QCOMPARE(testChar, testImage[testStringSize - 1]);
 }
 
+void HistoryTest::testCompactHistoryDropLines()
+{
+    const int maxLines = 100;
+    CompactHistoryScroll history(maxLines);
+
+    // lines of varying length, long enough to span several storage chunks
+    auto lineLength = [](int line) {
+        return (line * 7919) % 9000;
+    };
+    auto cellAt = [](int line, int column) {
+        return Character(uint('a' + (line + column) % 26));
+    };
+
+    const int totalLines = 5000;
+    for (int line = 0; line < totalLines; ++line) {
+        QVector<Character> cells(lineLength(line));
+        for (int column = 0; column < cells.size(); ++column) {
+            cells[column] = cellAt(line, column);
+        }
+        history.addCellsMove(cells.data(), cells.size());
+        history.addLine();
+    }
+
+    QVERIFY(history.getLines() >= maxLines);
+    QVERIFY(history.getLines() <= maxLines + 5);
+
+    // the newest lines must still be intact
+    const int firstLine = totalLines - history.getLines();
+    for (int line = 0; line < history.getLines(); ++line) {
+        const int length = lineLength(firstLine + line);
+        QCOMPARE(history.getLineLen(line), length);
+
+        QVector<Character> cells(length);
+        history.getCells(line, 0, length, cells.data());
+        for (int column = 0; column < length; ++column) {
+            QCOMPARE(cells.at(column), cellAt(firstLine + line, column));
+        }
+    }
+}
+
+void HistoryTest::testCompactHistoryEncoding()
+{
+    CompactHistoryScroll history(10);
+
+    auto makeCell = [](uint c, ExtraFlags flags = EF_REAL) {
+        Character cell(c);
+        cell.flags = flags;
+        if (c <= '~' && c > ' ') {
+            cell.flags |= EF_ASCII_WORD;
+        }
+        return cell;
+    };
+
+    QVector<QVector<Character>> lines;
+
+    // plain ASCII with a single attribute set
+    QVector<Character> line;
+    for (QChar c : QStringLiteral("ls -l /usr/share/konsole")) {
+        line.append(makeCell(c.unicode()));
+    }
+    lines.append(line);
+
+    // several attribute spans, Latin-1 and wide code points
+    line.clear();
+    const QString text = QStringLiteral("caf\u00e9 \u4f60\u597d");
+    for (int i = 0; i < text.size(); ++i) {
+        Character cell = makeCell(text.at(i).unicode(), EF_REAL | EF_REPL_OUTPUT);
+        if (i >= 2 && i < 6) {
+            cell.foregroundColor = CharacterColor(COLOR_SPACE_256, 196);
+            cell.rendition.f.bold = 1;
+        }
+        line.append(cell);
+    }
+    lines.append(line);
+
+    // EF_ASCII_WORD that does not follow from the code point
+    line = {makeCell('a'), makeCell('b'), makeCell('c')};
+    line[1].flags &= ~EF_ASCII_WORD;
+    line.append(makeCell(' ', EF_REAL | EF_ASCII_WORD));
+    lines.append(line);
+
+    // an empty line
+    lines.append(QVector<Character>());
+
+    for (QVector<Character> cells : lines) {
+        history.addCellsMove(cells.data(), cells.size());
+        history.addLine();
+    }
+
+    QCOMPARE(history.getLines(), int(lines.size()));
+    for (int i = 0; i < lines.size(); ++i) {
+        const QVector<Character> &expected = lines.at(i);
+        QCOMPARE(history.getLineLen(i), int(expected.size()));
+
+        // the whole line, and a part of it
+        for (int start : {0, 2}) {
+            const int count = std::max<int>(0, expected.size() - start - 1);
+            QVector<Character> cells(count);
+            history.getCells(i, start, count, cells.data());
+            for (int column = 0; column < count; ++column) {
+                const Character &cell = cells.at(column);
+                QCOMPARE(cell, expected.at(start + column));
+                QCOMPARE(cell.flags, expected.at(start + column).flags);
+            }
+        }
+    }
+}
+
+void HistoryTest::testCompactHistoryCompression()
+{
+    CompactHistoryType unlimited(CompactHistoryType::Unlimited, true);
+    QVERIFY(unlimited.isUnlimited());
+    QVERIFY(unlimited.isCompressed());
+
+    std::unique_ptr<HistoryScroll> history;
+    unlimited.scroll(history);
+    QVERIFY(history->getType().isUnlimited());
+
+    auto lineText = [](int line) {
+        return QStringLiteral("%1: build step %2 finished, status ok").arg(line).arg(line % 97);
+    };
+
+    // enough lines for many compressed chunks
+    const int totalLines = 100000;
+    for (int line = 0; line < totalLines; ++line) {
+        const QString text = lineText(line);
+        QVector<Character> cells;
+        for (QChar c : text) {
+            cells.append(Character(c.unicode()));
+        }
+        history->addCellsMove(cells.data(), cells.size());
+        history->addLine();
+    }
+    QCOMPARE(history->getLines(), totalLines);
+
+    auto verify = [&]() {
+        for (int line = 0; line < history->getLines(); line += 7) {
+            const QString text = lineText(line);
+            QCOMPARE(history->getLineLen(line), int(text.size()));
+
+            QVector<Character> cells(text.size());
+            history->getCells(line, 0, cells.size(), cells.data());
+            for (int column = 0; column < cells.size(); ++column) {
+                QCOMPARE(cells.at(column).character, char32_t(text.at(column).unicode()));
+            }
+        }
+    };
+    verify();
+
+    // switching to a fixed size keeps the lines and the compression
+    CompactHistoryType(totalLines * 2, true).scroll(history);
+    QVERIFY(!history->getType().isUnlimited());
+    QVERIFY(history->getType().isCompressed());
+    verify();
+
+    CompactHistoryType(totalLines * 2, false).scroll(history);
+    QVERIFY(!history->getType().isCompressed());
+    verify();
+}
+
+void HistoryTest::testHistoryScrollFileWindows()
+{
+    HistoryScrollFile history;
+
+    // enough cells for several mapped windows, read while still being added
+    const int totalLines = 20000;
+    const int lineLength = 100;
+    auto cellAt = [](int line, int column) {
+        return Character(uint('a' + (line * 3 + column) % 26));
+    };
+
+    QVector<Character> cells(lineLength);
+    for (int line = 0; line < totalLines; ++line) {
+        for (int column = 0; column < lineLength; ++column) {
+            cells[column] = cellAt(line, column);
+        }
+        history.addCells(cells.data(), lineLength);
+        history.addLine();
+
+        if (line % 1000 == 999) {
+            const int oldLine = line / 2;
+            history.getCells(oldLine, 0, lineLength, cells.data());
+            QCOMPARE(cells.at(lineLength - 1), cellAt(oldLine, lineLength - 1));
+        }
+    }
+    QCOMPARE(history.getLines(), totalLines);
+
+    LineProperty wrapped;
+    wrapped.flags.f.wrapped = 1;
+    history.setLineProperty(10, wrapped);
+    history.setLineProperty(totalLines - 1, wrapped);
+    QVERIFY(history.isWrappedLine(10));
+    QVERIFY(!history.isWrappedLine(11));
+    QVERIFY(history.isWrappedLine(totalLines - 1));
+
+    history.removeCells();
+    QCOMPARE(history.getLines(), totalLines - 1);
+
+    for (int line = 0; line < history.getLines(); line += 997) {
+        QCOMPARE(history.getLineLen(line), lineLength);
+        history.getCells(line, 0, lineLength, cells.data());
+        for (int column = 0; column < lineLength; ++column) {
+            QCOMPARE(cells.at(column), cellAt(line, column));
+        }
+    }
+}
+
 void HistoryTest::testHistoryTypeChange()
 {
     std::unique_ptr<HistoryScroll> historyScroll(nullptr);
@@ -218,6 +427,182 @@ void HistoryTest::testHistoryTypeChange()
     QCOMPARE(historyScroll->getLines(), 0);
 }
 
+void HistoryTest::testHistorySearchIndex()
+{
+    CompactHistoryScroll history(1000);
+
+    auto addLine = [&history](const QString &text, bool wrapped = false) {
+        QVector<Character> cells;
+        for (QChar c : text) {
+            Character cell(c.unicode());
+            cell.flags = EF_REAL;
+            cells.append(cell);
+            // double width characters are followed by an empty cell
+            if (Character::width(c.unicode()) == 2) {
+                Character rightHalf;
+                rightHalf.setRightHalfOfDoubleWide();
+                rightHalf.flags = EF_REAL;
+                cells.append(rightHalf);
+            }
+        }
+        history.addCellsMove(cells.data(), cells.size());
+        LineProperty lineProperty;
+        lineProperty.flags.f.wrapped = wrapped ? 1 : 0;
+        history.addLine(lineProperty);
+    };
+    auto containsLine = [](const QVector<std::pair<int, int>> &ranges, int line) {
+        return std::any_of(ranges.cbegin(), ranges.cend(), [line](const std::pair<int, int> &range) {
+            return range.first <= line && line <= range.second;
+        });
+    };
+
+    for (int i = 0; i < 500; ++i) {
+        addLine(i == 100 || i == 350 ? QStringLiteral("make: *** [all] Error 2") : QStringLiteral("compiling file %1.cpp").arg(i));
+    }
+
+    QVector<std::pair<int, int>> ranges;
+    QVERIFY(!history.searchCandidates(QStringLiteral("error"), &ranges));
+    history.setSearchIndexEnabled(true);
+
+    // the index is built by the first query, and is case insensitive
+    QVERIFY(history.searchCandidates(QStringLiteral("ERROR"), &ranges));
+    QVERIFY(containsLine(ranges, 100));
+    QVERIFY(containsLine(ranges, 350));
+    QVERIFY(!containsLine(ranges, 200));
+    QVERIFY(!containsLine(ranges, 499));
+
+    // too short to narrow down the lines
+    QVERIFY(!history.searchCandidates(QStringLiteral("Er"), &ranges));
+
+    // lines added later are indexed by the next query, across wrapped lines too
+    addLine(QStringLiteral("linking ... fatal er"), true);
+    addLine(QStringLiteral("ror: undefined reference"));
+    QVERIFY(!history.hasSearchIndex());
+    QVERIFY(history.searchCandidates(QStringLiteral("fatal error"), &ranges));
+    QVERIFY(history.hasSearchIndex());
+    QVERIFY(containsLine(ranges, 500));
+    QVERIFY(!containsLine(ranges, 100));
+
+    // the empty cells after double width characters are skipped
+    addLine(QStringLiteral("\u6771\u4EAC: Error 3"));
+    QVERIFY(history.searchCandidates(QStringLiteral("\u4EAC: error"), &ranges));
+    QVERIFY(containsLine(ranges, 502));
+    QVERIFY(!containsLine(ranges, 100));
+
+    // dropped lines are no longer reported
+    history.setMaxNbLines(300);
+    QVERIFY(history.searchCandidates(QStringLiteral("Error 2"), &ranges));
+    QVERIFY(containsLine(ranges, 350 - 202));
+    QVERIFY(!containsLine(ranges, 0));
+    for (const auto &range : std::as_const(ranges)) {
+        QVERIFY(range.second < history.getLines());
+    }
+
+    // reflowing rebuilds the index
+    QCOMPARE(history.reflowLines(40), 0);
+    QVERIFY(history.searchCandidates(QStringLiteral("Error 2"), &ranges));
+    QVERIFY(containsLine(ranges, 350 - 202));
+    QVERIFY(ranges.last().second < history.getLines());
+
+    // disabling the index frees it
+    history.setSearchIndexEnabled(false);
+    QVERIFY(!history.hasSearchIndex());
+    QVERIFY(!history.searchCandidates(QStringLiteral("Error 2"), &ranges));
+}
+
+void HistoryTest::testHistorySearchIndexFullHistory()
+{
+    CompactHistoryScroll history(100);
+    history.setSearchIndexEnabled(true);
+
+    auto addLine = [&history](const QString &text) {
+        QVector<Character> cells;
+        for (QChar c : text) {
+            Character cell(c.unicode());
+            cell.flags = EF_REAL;
+            cells.append(cell);
+        }
+        history.addCellsMove(cells.data(), cells.size());
+        history.addLine(LineProperty());
+    };
+    auto lineText = [&history](int line) {
+        QVector<Character> cells(history.getLineLen(line));
+        history.getCells(line, 0, cells.size(), cells.data());
+        QString text;
+        for (const Character &cell : std::as_const(cells)) {
+            text += QChar(cell.character);
+        }
+        return text;
+    };
+
+    for (int i = 0; i < 50; ++i) {
+        addLine(QStringLiteral("compiling file %1.cpp").arg(i));
+    }
+    QVector<std::pair<int, int>> ranges;
+    QVERIFY(history.searchCandidates(QStringLiteral("error"), &ranges));
+    QVERIFY(ranges.isEmpty());
+    QVERIFY(history.hasSearchIndex());
+
+    // lines dropped from the top of a full history are trimmed from the index,
+    // whether or not they were indexed
+    for (int i = 50; i < 1000; ++i) {
+        addLine(i % 70 == 0 ? QStringLiteral("make: *** [all] Error 2") : QStringLiteral("compiling file %1.cpp").arg(i));
+        QVERIFY(!history.hasSearchIndex());
+        if (i % 37 == 0) {
+            QVERIFY(history.searchCandidates(QStringLiteral("Error 2"), &ranges));
+            QVERIFY(history.hasSearchIndex());
+        }
+    }
+    QVERIFY(history.getLines() <= 105);
+
+    QVERIFY(history.searchCandidates(QStringLiteral("Error 2"), &ranges));
+    QVERIFY(!ranges.isEmpty());
+    for (int line = 0; line < history.getLines(); ++line) {
+        if (lineText(line).contains(QLatin1String("Error 2"))) {
+            QVERIFY(std::any_of(ranges.cbegin(), ranges.cend(), [line](const std::pair<int, int> &range) {
+                return range.first <= line && line <= range.second;
+            }));
+        }
+    }
+    for (const auto &range : std::as_const(ranges)) {
+        QVERIFY(range.second < history.getLines());
+    }
+}
+
+void HistoryTest::testEmulationSearchIndex()
+{
+    auto session = std::make_unique<Session>();
+    Emulation *emulation = session->emulation();
+    emulation->setHistory(CompactHistoryType(1000));
+    for (int i = 0; i < 100; ++i) {
+        const QByteArray line = QStringLiteral("output line %1\r\n").arg(i).toUtf8();
+        emulation->receiveData(line.constData(), line.size());
+    }
+
+    // the index is only kept if the profile allows it
+    QVector<std::pair<int, int>> ranges;
+    emulation->setSearchIndexEnabled(true);
+    QVERIFY(!emulation->isSearchIndexEnabled());
+    QVERIFY(!emulation->searchCandidates(QStringLiteral("line 42"), &ranges));
+
+    emulation->setSearchIndexAllowed(true);
+    emulation->setSearchIndexEnabled(true);
+    QVERIFY(emulation->isSearchIndexEnabled());
+    QVERIFY(emulation->searchCandidates(QStringLiteral("line 42"), &ranges));
+
+    // changing the history type keeps the index enabled
+    emulation->setHistory(CompactHistoryType(500));
+    QVERIFY(emulation->isSearchIndexEnabled());
+
+    emulation->setSearchIndexEnabled(false);
+    QVERIFY(!emulation->isSearchIndexEnabled());
+    QVERIFY(!emulation->searchCandidates(QStringLiteral("line 42"), &ranges));
+
+    emulation->setSearchIndexEnabled(true);
+    emulation->setSearchIndexAllowed(false);
+    QVERIFY(!emulation->isSearchIndexEnabled());
+}
+
 QTEST_MAIN(HistoryTest)
 
 #include "moc_HistoryTest.cpp"
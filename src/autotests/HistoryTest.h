@@ -32,6 +32,13 @@ private Q_SLOTS:
     void testEmulationHistory();
     void testHistoryScroll();
     void testHistoryReflow();
+    void testCompactHistoryDropLines();
+    void testCompactHistoryEncoding();
+    void testCompactHistoryCompression();
+    void testHistoryScrollFileWindows();
+    void testHistorySearchIndex();
+    void testHistorySearchIndexFullHistory();
+    void testEmulationSearchIndex();
     void testHistoryTypeChange();
 
 private:
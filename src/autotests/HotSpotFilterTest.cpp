@@ -5,7 +5,13 @@
 */
 
 #include "HotSpotFilterTest.h"
+#include "filterHotSpots/ColorFilter.h"
+#include "filterHotSpots/DirectoryListing.h"
 #include "filterHotSpots/HotSpot.h"
+#include "filterHotSpots/LiteralPrefilter.h"
+#include "filterHotSpots/TerminalImageFilterChain.h"
+#include <QFile>
+#include <QTemporaryDir>
 #include <QTest>
 
 QTEST_GUILESS_MAIN(HotSpotFilterTest)
@@ -199,4 +205,180 @@ void HotSpotFilterTest::testUrlFilter()
     }
 }
 
+void HotSpotFilterTest::testTerminalImageFilterChain()
+{
+    const int columns = 20;
+    const auto image = [](const QStringList &lines) {
+        QVector<Konsole::Character> characters(lines.size() * columns);
+        for (int i = 0; i < lines.size(); i++) {
+            for (int j = 0; j < lines.at(i).size(); j++) {
+                characters[i * columns + j] = Konsole::Character(lines.at(i).at(j).unicode());
+            }
+        }
+        return characters;
+    };
+    const QVector<Konsole::LineProperty> lineProperties(4, Konsole::LineProperty());
+
+    Konsole::TerminalImageFilterChain chain(nullptr);
+    auto *filter = new Konsole::UrlFilter();
+    chain.addFilter(filter);
+    QVERIFY(filter->isLineLocal());
+
+    auto characters = image({QStringLiteral("see https://kde.org"), QStringLiteral("nothing"), QStringLiteral("www.example.com"), QStringLiteral("nothing")});
+    chain.setImage(characters.constData(), 4, columns, lineProperties);
+    chain.process();
+
+    auto hotSpots = chain.hotSpots();
+    QCOMPARE(hotSpots.size(), 2);
+    QCOMPARE(hotSpots.at(0)->startLine(), 0);
+    QCOMPARE(hotSpots.at(0)->startColumn(), 4);
+    QCOMPARE(hotSpots.at(1)->startLine(), 2);
+    const QSharedPointer<Konsole::HotSpot> kept = hotSpots.at(1);
+
+    // scroll by a line: the hotspot of the unchanged line is kept and moved
+    characters = image({QStringLiteral("nothing"), QStringLiteral("www.example.com"), QStringLiteral("nothing"), QStringLiteral("https://new.org")});
+    chain.setImage(characters.constData(), 4, columns, lineProperties);
+    chain.process();
+
+    hotSpots = chain.hotSpots();
+    QCOMPARE(hotSpots.size(), 2);
+    QCOMPARE(hotSpots.at(0).data(), kept.data());
+    QCOMPARE(hotSpots.at(0)->startLine(), 1);
+    QCOMPARE(hotSpots.at(0)->endLine(), 1);
+    QCOMPARE(hotSpots.at(0)->startColumn(), 0);
+    QCOMPARE(hotSpots.at(0)->endColumn(), 15);
+    QCOMPARE(hotSpots.at(1)->startLine(), 3);
+    QCOMPARE(chain.hotSpotAt(3, 2).data(), hotSpots.at(1).data());
+
+    // a changed line is matched again
+    characters = image({QStringLiteral("nothing"), QStringLiteral("www.example.org/x"), QStringLiteral("nothing"), QStringLiteral("https://new.org")});
+    chain.setImage(characters.constData(), 4, columns, lineProperties);
+    chain.process();
+
+    hotSpots = chain.hotSpots();
+    QCOMPARE(hotSpots.size(), 2);
+    QVERIFY(hotSpots.at(0) != kept);
+    QCOMPARE(hotSpots.at(0)->endColumn(), 17);
+}
+
+void HotSpotFilterTest::testDirectoryListing()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QFile file(dir.filePath(QStringLiteral("existing.txt")));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.close();
+
+    const std::shared_ptr<Konsole::DirectoryListing> listing = Konsole::DirectoryListing::forPath(dir.path());
+    QVERIFY(Konsole::DirectoryListing::forPath(dir.path()) == listing);
+
+    // the directory is listed in the background
+    QTRY_VERIFY(listing->contains(QStringLiteral("existing.txt")));
+    QVERIFY(!listing->contains(QStringLiteral("created.txt")));
+
+    const int revision = listing->revision();
+    file.setFileName(dir.filePath(QStringLiteral("created.txt")));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.close();
+
+    QTRY_VERIFY(listing->contains(QStringLiteral("created.txt")));
+    QVERIFY(listing->revision() != revision);
+}
+
+void HotSpotFilterTest::testColorFilter()
+{
+    const QString text = QStringLiteral("red foobar #3e3 #feed TOMATO");
+    QVector<Konsole::Character> characters(text.size());
+    for (int i = 0; i < text.size(); i++) {
+        characters[i] = Konsole::Character(text.at(i).unicode());
+    }
+
+    Konsole::TerminalImageFilterChain chain(nullptr);
+    chain.addFilter(new Konsole::ColorFilter());
+    chain.setImage(characters.constData(), 1, text.size(), QVector<Konsole::LineProperty>(1, Konsole::LineProperty()));
+    chain.process();
+
+    // neither "foobar" nor "#feed" are colors
+    const auto hotSpots = chain.hotSpots();
+    QCOMPARE(hotSpots.size(), 3);
+    QCOMPARE(hotSpots.at(0)->startColumn(), 0);
+    QCOMPARE(hotSpots.at(1)->startColumn(), 11);
+    QCOMPARE(hotSpots.at(2)->startColumn(), 22);
+    QCOMPARE(hotSpots.at(2)->type(), Konsole::HotSpot::Color);
+}
+
+void HotSpotFilterTest::testLiteralPrefilter_data()
+{
+    QTest::addColumn<QString>("pattern");
+    QTest::addColumn<QStringList>("literals");
+    QTest::addColumn<bool>("canFilter");
+
+    QTest::newRow("escaped_literal") << QRegularExpression::escape(QStringLiteral("make: *** [all]")) << QStringList{QStringLiteral("make: *** [all]")} << true;
+    QTest::newRow("optional") << QStringLiteral("colou?r") << QStringList{QStringLiteral("colour"), QStringLiteral("color")} << true;
+    QTest::newRow("alternation") << QStringLiteral("(https?|ftp)://\\S+")
+                                 << QStringList{QStringLiteral("https://"), QStringLiteral("http://"), QStringLiteral("ftp://")} << true;
+    QTest::newRow("longest_required") << QStringLiteral("[a-z]+@example\\.com") << QStringList{QStringLiteral("@example.com")} << true;
+    QTest::newRow("repeated_group") << QStringLiteral("(ab|cd)*ef") << QStringList{QStringLiteral("ef")} << true;
+    QTest::newRow("no_literal") << QStringLiteral("\\d+") << QStringList() << false;
+    QTest::newRow("branch_without_literal") << QStringLiteral("error|\\w+") << QStringList() << false;
+    QTest::newRow("matches_newline") << QStringLiteral("foo\\s+bar") << QStringList{QStringLiteral("foo")} << false;
+    QTest::newRow("anchored") << QStringLiteral("^foo") << QStringList{QStringLiteral("foo")} << false;
+    QTest::newRow("option_setting") << QStringLiteral("(?i)foo") << QStringList() << false;
+    QTest::newRow("negated_class") << QStringLiteral("'[^'\\n]+'") << QStringList{QStringLiteral("'")} << true;
+    QTest::newRow("negated_class_with_newline") << QStringLiteral("'[^']+'") << QStringList{QStringLiteral("'")} << false;
+    QTest::newRow("property") << QStringLiteral("\\p{L}+\\.txt") << QStringList{QStringLiteral(".txt")} << true;
+    QTest::newRow("url") << Konsole::UrlFilter::CompleteUrlRegExp.pattern()
+                         << QStringList{QStringLiteral("www."), QStringLiteral("://"), QStringLiteral("@")} << true;
+}
+
+void HotSpotFilterTest::testLiteralPrefilter()
+{
+    QFETCH(QString, pattern);
+    QFETCH(QStringList, literals);
+    QFETCH(bool, canFilter);
+
+    const Konsole::LiteralPrefilter prefilter{QRegularExpression(pattern)};
+    QCOMPARE(prefilter.literals(), literals);
+    QCOMPARE(prefilter.canFilter(), canFilter);
+}
+
+void HotSpotFilterTest::testLiteralPrefilterSpans()
+{
+    const QString text = QStringLiteral(
+        "no links here\n"
+        "see https://kde.org and\n"
+        "www.example.com\n"
+        "\n"
+        "mail someone@example.com\n"
+        "nothing");
+
+    const QRegularExpression &regex = Konsole::UrlFilter::CompleteUrlRegExp;
+    const Konsole::LiteralPrefilter prefilter(regex);
+    const QList<Konsole::LiteralPrefilter::Span> spans = prefilter.candidateSpans(text);
+
+    // the first and the last two lines can't contain a url
+    QCOMPARE(spans.size(), 2);
+    QCOMPARE(text.mid(spans.at(0).first, spans.at(0).second), QStringLiteral("see https://kde.org and\nwww.example.com"));
+    QCOMPARE(text.mid(spans.at(1).first, spans.at(1).second), QStringLiteral("mail someone@example.com"));
+
+    // matching the spans finds the same as matching the whole text
+    QStringList expected;
+    QRegularExpressionMatchIterator iterator = regex.globalMatch(text);
+    while (iterator.hasNext()) {
+        expected.append(iterator.next().captured(0));
+    }
+    QStringList found;
+    for (const auto &[start, length] : spans) {
+        iterator = regex.globalMatchView(QStringView(text).mid(start, length));
+        while (iterator.hasNext()) {
+            found.append(iterator.next().captured(0));
+        }
+    }
+    QCOMPARE(found, expected);
+
+    // case insensitive patterns are filtered case insensitively
+    const Konsole::LiteralPrefilter insensitive(QRegularExpression(QStringLiteral("NOTHING"), QRegularExpression::CaseInsensitiveOption));
+    QCOMPARE(insensitive.candidateSpans(text), QList<Konsole::LiteralPrefilter::Span>{{text.lastIndexOf(QLatin1Char('\n')) + 1, 7}});
+}
+
 #include "moc_HotSpotFilterTest.cpp"
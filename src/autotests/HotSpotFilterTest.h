@@ -19,6 +19,14 @@ private Q_SLOTS:
 
     void testUrlFilter_data();
     void testUrlFilter();
+
+    void testLiteralPrefilter_data();
+    void testLiteralPrefilter();
+    void testLiteralPrefilterSpans();
+
+    void testTerminalImageFilterChain();
+    void testDirectoryListing();
+    void testColorFilter();
 };
 
 #endif // HOTSPOTFILTERTEST_H
@@ -10,6 +10,9 @@
 // Qt
 #include <QString>
 
+// Konsole
+#include "../EscapeSequenceUrlExtractor.h"
+
 // KDE
 #include <QTest>
 
@@ -242,6 +245,131 @@ void ScreenTest::testCursorPosition()
     delete screen;
 }
 
+// Test: displayString gives the same result as displayCharacter for each character,
+// including wrapping at the right margin and insert mode
+void ScreenTest::testDisplayString()
+{
+    const int columns = 10;
+    const QString text = QStringLiteral("The quick brown fox jumps over the lazy dog");
+    QVector<uint> chars;
+    for (const QChar &c : text) {
+        chars.append(c.unicode());
+    }
+
+    Screen perCharacter(largeScreenLines, columns);
+    Screen bulk(largeScreenLines, columns);
+
+    for (uint c : chars) {
+        perCharacter.displayCharacter(c);
+    }
+    bulk.displayString(chars.constData(), chars.size());
+
+    doComparePosition(&bulk, perCharacter.getCursorY(), perCharacter.getCursorX());
+    QCOMPARE(bulk.text(0, largeScreenLines * columns - 1, Screen::PlainText),
+             perCharacter.text(0, largeScreenLines * columns - 1, Screen::PlainText));
+
+    perCharacter.setCursorYX(1, 3);
+    bulk.setCursorYX(1, 3);
+    perCharacter.setMode(MODE_Insert);
+    bulk.setMode(MODE_Insert);
+
+    for (int i = 0; i < 12; ++i) {
+        perCharacter.displayCharacter(chars.at(i));
+    }
+    bulk.displayString(chars.constData(), 12);
+
+    doComparePosition(&bulk, perCharacter.getCursorY(), perCharacter.getCursorX());
+    QCOMPARE(bulk.text(0, largeScreenLines * columns - 1, Screen::PlainText),
+             perCharacter.text(0, largeScreenLines * columns - 1, Screen::PlainText));
+}
+
+void ScreenTest::testUrlExtractorHistoryLinesRemoved()
+{
+    Screen screen(largeScreenLines, 40);
+    screen.setEnableUrlExtractor(true);
+    EscapeSequenceUrlExtractor *extractor = screen.urlExtractor();
+    extractor->setAllowedLinkSchema({QStringLiteral("https://")});
+
+    const auto writeUrl = [&](int row) {
+        const QString text = QStringLiteral("link%1").arg(row);
+        screen.setCursorYX(row + 1, 1);
+        extractor->toggleUrlInput();
+        extractor->setUrl(QStringLiteral("https://kde.org/%1").arg(row));
+        for (const QChar &c : text) {
+            screen.displayCharacter(c.unicode());
+        }
+        extractor->toggleUrlInput();
+    };
+
+    for (int row = 0; row < 5; ++row) {
+        writeUrl(row);
+    }
+    QCOMPARE(extractor->history().size(), 5);
+
+    // the URL's on the dropped lines are removed, and the others move up
+    extractor->historyLinesRemoved(2);
+    QVector<ExtractedUrl> urls = extractor->history();
+    QCOMPARE(urls.size(), 3);
+    for (int i = 0; i < urls.size(); ++i) {
+        QCOMPARE(urls.at(i).begin.row, i);
+        QCOMPARE(urls.at(i).end.row, i);
+        QCOMPARE(urls.at(i).text, QStringLiteral("link%1").arg(i + 2));
+    }
+
+    urls = extractor->urlsBetween(1, 1);
+    QCOMPARE(urls.size(), 1);
+    QCOMPARE(urls.at(0).text, QStringLiteral("link3"));
+    QCOMPARE(urls.at(0).url, QStringLiteral("https://kde.org/3"));
+
+    // URL's written after the lines were dropped use the same rows
+    writeUrl(6);
+    urls = extractor->history();
+    QCOMPARE(urls.size(), 4);
+    QCOMPARE(urls.last().begin.row, 6);
+    QCOMPARE(extractor->urlsBetween(4, 9).size(), 1);
+
+    extractor->historyLinesRemoved(10);
+    QVERIFY(extractor->history().isEmpty());
+}
+
+void ScreenTest::testDamageTracking()
+{
+    Screen screen(largeScreenLines, 40);
+
+    // writing only damages the line of the cursor
+    quint64 stamp = screen.damageStamp();
+    screen.setCursorYX(4, 1);
+    screen.displayCharacter('a');
+    for (int line = 0; line < largeScreenLines; ++line) {
+        QCOMPARE(screen.isLineDamagedSince(line, stamp), line == 3);
+    }
+    QVERIFY(!screen.isFullyDamagedSince(stamp));
+
+    // a single line of the image is copied with the cursor on it
+    Character image[40];
+    screen.getImage(image, 40, 3, 3);
+    QCOMPARE(image[0].character, uint('a'));
+    QVERIFY(image[1].rendition.f.cursor);
+
+    // scrolling damages the scrolled lines
+    stamp = screen.damageStamp();
+    screen.setCursorYX(8, 1);
+    screen.deleteLines(1);
+    for (int line = 0; line < largeScreenLines; ++line) {
+        QCOMPARE(screen.isLineDamagedSince(line, stamp), line >= 7);
+    }
+
+    // changing the selection or the size damages everything
+    stamp = screen.damageStamp();
+    screen.setSelectionStart(0, 0, false);
+    QVERIFY(screen.isFullyDamagedSince(stamp));
+    QVERIFY(screen.isLineDamagedSince(0, stamp));
+
+    stamp = screen.damageStamp();
+    screen.resizeImage(largeScreenLines + 2, 40);
+    QVERIFY(screen.isFullyDamagedSince(stamp));
+}
+
 QTEST_GUILESS_MAIN(ScreenTest)
 
 #include "moc_ScreenTest.cpp"
@@ -24,6 +24,9 @@ private Q_SLOTS:
     void testBlockSelection();
     void testCJKBlockSelection();
     void testCursorPosition();
+    void testDisplayString();
+    void testUrlExtractorHistoryLinesRemoved();
+    void testDamageTracking();
 
 private:
     void doLargeScreenCopyVerification(const QString &putToScreen, const QString &expectedSelection);
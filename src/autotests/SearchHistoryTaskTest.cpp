@@ -0,0 +1,177 @@
+/*
+    SPDX-FileCopyrightText: 2026 Konsole Plus contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+// Own
+#include "SearchHistoryTaskTest.h"
+
+// Qt
+#include <QSignalSpy>
+#include <QTest>
+
+// STD
+#include <algorithm>
+#include <memory>
+#include <optional>
+
+// Konsole
+#include "../Emulation.h"
+#include "../ScreenWindow.h"
+#include "../SearchHistoryTask.h"
+#include "../history/compact/CompactHistoryType.h"
+#include "../session/Session.h"
+
+using namespace Konsole;
+
+namespace
+{
+using LineRanges = QVector<std::pair<int, int>>;
+
+void receiveText(Session *session, const QString &text)
+{
+    const QByteArray data = text.toUtf8();
+    session->emulation()->receiveData(data.constData(), data.size());
+}
+
+// Returns the lines of @p session matching @p text, searching only @p candidates if given
+QList<int> searchLines(Session *session, ScreenWindow *window, const QString &text, const std::optional<LineRanges> &candidates = std::nullopt)
+{
+    auto task = std::make_unique<SearchHistoryTask>();
+    task->setAutoDelete(false);
+    task->addScreenWindow(session, window);
+    task->setRegExp(QRegularExpression(QRegularExpression::escape(text)));
+    task->setSearchDirection(Enum::ForwardsSearch);
+    task->setStartLine(0);
+    if (candidates) {
+        task->setCandidateLines(*candidates);
+    }
+
+    QList<int> lines;
+    QObject::connect(task.get(), &SearchHistoryTask::searchResults, task.get(), [&lines](const QList<int> &found) {
+        lines.append(found);
+    });
+    QSignalSpy finished(task.get(), &SearchHistoryTask::finished);
+    task->execute();
+    if (finished.isEmpty() && !finished.wait()) {
+        return {};
+    }
+
+    std::sort(lines.begin(), lines.end());
+    return lines;
+}
+}
+
+void SearchHistoryTaskTest::testLinesAround()
+{
+    // "error" found as "err" at offset 0 on lines 3 and 20 of 10 columns
+    QCOMPARE(SearchHistoryTask::linesAround({3, 20}, 0, 5, 10), LineRanges({{3, 4}, {20, 21}}));
+    // "an error" found as "error" at offset 3, which may start a line earlier
+    QCOMPARE(SearchHistoryTask::linesAround({3, 20}, 3, 8, 10), LineRanges({{2, 4}, {19, 21}}));
+    // overlapping ranges are merged without shrinking the earlier one
+    QCOMPARE(SearchHistoryTask::linesAround({3, 4}, 0, 15, 10), LineRanges({{3, 7}}));
+    QCOMPARE(SearchHistoryTask::linesAround({0}, 20, 20, 10), LineRanges({{0, 4}}));
+}
+
+void SearchHistoryTaskTest::testNarrowedSearchAcrossWrap()
+{
+    auto session = std::make_unique<Session>();
+    Emulation *emulation = session->emulation();
+    emulation->setHistory(CompactHistoryType(1000));
+    emulation->setImageSize(5, 10);
+    ScreenWindow *window = emulation->createWindow();
+
+    for (int i = 0; i < 20; ++i) {
+        receiveText(session.get(), QStringLiteral("line %1\r\n").arg(i));
+    }
+    // "error" is wrapped after "err"
+    receiveText(session.get(), QStringLiteral("1234567error here\r\n"));
+    for (int i = 0; i < 10; ++i) {
+        receiveText(session.get(), QStringLiteral("line %1\r\n").arg(i));
+    }
+
+    const QList<int> partLines = searchLines(session.get(), window, QStringLiteral("err"));
+    QCOMPARE(partLines.size(), 1);
+    const int wrappedLine = partLines.first();
+
+    // the match doesn't fit in the line the part was found on
+    QVERIFY(searchLines(session.get(), window, QStringLiteral("error"), LineRanges({{wrappedLine, wrappedLine}})).isEmpty());
+
+    const QString text = QStringLiteral("error");
+    const LineRanges candidates = SearchHistoryTask::linesAround(partLines, text.indexOf(QStringLiteral("err")), text.size(), window->columnCount());
+    QCOMPARE(searchLines(session.get(), window, text, candidates), partLines);
+    QCOMPARE(searchLines(session.get(), window, text), partLines);
+}
+
+void SearchHistoryTaskTest::testOutputChangedWhileSearching_data()
+{
+    QTest::addColumn<int>("change");
+
+    QTest::newRow("clear scrollback") << 0;
+    QTest::newRow("alternate screen") << 1;
+    QTest::newRow("history type") << 2;
+    QTest::newRow("dropped lines") << 3;
+}
+
+void SearchHistoryTaskTest::testOutputChangedWhileSearching()
+{
+    QFETCH(int, change);
+
+    auto session = std::make_unique<Session>();
+    Emulation *emulation = session->emulation();
+    emulation->setHistory(CompactHistoryType(20000));
+    ScreenWindow *window = emulation->createWindow();
+
+    // enough lines to fill the history and to be searched over several turns of the event loop
+    QString output;
+    for (int i = 0; i < 40000; ++i) {
+        output += (i % 1000 == 999) ? QStringLiteral("error %1\r\n").arg(i) : QStringLiteral("line %1\r\n").arg(i);
+    }
+    receiveText(session.get(), output);
+
+    SearchHistoryTask task;
+    task.addScreenWindow(session.get(), window);
+    task.setRegExp(QRegularExpression(QStringLiteral("error")));
+    task.setSearchDirection(Enum::ForwardsSearch);
+    task.setStartLine(0);
+
+    QList<int> lines;
+    connect(&task, &SearchHistoryTask::searchResults, this, [&lines](const QList<int> &found) {
+        lines.append(found);
+    });
+    QSignalSpy finished(&task, &SearchHistoryTask::finished);
+    task.execute();
+
+    switch (change) {
+    case 0:
+        emulation->clearHistory();
+        break;
+    case 1:
+        receiveText(session.get(), QStringLiteral("\x1b[?1049h"));
+        break;
+    case 2:
+        emulation->setHistory(CompactHistoryType(100));
+        break;
+    case 3: {
+        const qint64 droppedLines = emulation->droppedLineCount();
+        receiveText(session.get(), output.left(output.size() / 8));
+        QVERIFY(emulation->droppedLineCount() > droppedLines);
+        break;
+    }
+    }
+
+    if (finished.isEmpty()) {
+        QVERIFY(finished.wait());
+    }
+
+    // every line reported is a match at its current position
+    for (const int line : std::as_const(lines)) {
+        QVERIFY(line < emulation->lineCount());
+        QVERIFY(SearchHistoryTask::decodeLines(session.get(), line, line).text.contains(QLatin1String("error")));
+    }
+}
+
+QTEST_MAIN(SearchHistoryTaskTest)
+
+#include "moc_SearchHistoryTaskTest.cpp"
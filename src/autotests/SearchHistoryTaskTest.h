@@ -0,0 +1,27 @@
+/*
+    SPDX-FileCopyrightText: 2026 Konsole Plus contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef SEARCHHISTORYTASKTEST_H
+#define SEARCHHISTORYTASKTEST_H
+
+#include <QObject>
+
+namespace Konsole
+{
+class SearchHistoryTaskTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testLinesAround();
+    void testNarrowedSearchAcrossWrap();
+    void testOutputChangedWhileSearching_data();
+    void testOutputChangedWhileSearching();
+};
+
+}
+
+#endif // SEARCHHISTORYTASKTEST_H
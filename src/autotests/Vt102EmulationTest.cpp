@@ -463,6 +463,23 @@ void Vt102EmulationTest::testBufferedUpdates()
     QCOMPARE(outputChangedSpy.count(), 2);
 }
 
+void Vt102EmulationTest::testUtf8Decoding()
+{
+    // ASCII, 2, 3 and 4 byte sequences, stray continuation bytes, invalid bytes and a truncated sequence
+    const QByteArray input = QByteArrayLiteral("plain text: a\xC3\xB1o \xE2\x82\xAC \xF0\x9F\x98\x80 \x80\xFF \xE2\x82( end");
+    const QVector<uint> expected = QString(QStringDecoder(QStringConverter::Utf8).decode(input)).toUcs4();
+
+    // the result must not depend on where the pty splits the stream
+    for (int split = 0; split <= input.size(); ++split) {
+        TestEmulation em;
+        em.reset();
+        em.setCodec(TestEmulation::Utf8Codec);
+        em.receiveData(input.constData(), split);
+        em.receiveData(input.constData() + split, input.size() - split);
+        QCOMPARE(em.receivedChars, expected);
+    }
+}
+
 QTEST_GUILESS_MAIN(Vt102EmulationTest)
 
 #include "moc_Vt102EmulationTest.cpp"
@@ -34,6 +34,8 @@ private Q_SLOTS:
 
     void testBufferedUpdates();
 
+    void testUtf8Decoding();
+
 private:
     static void sendAndCompare(TestEmulation *em, const char *input, size_t inputLen, const QString &expectedPrint, const QByteArray &expectedSent);
 };
@@ -83,12 +85,14 @@ public:
 
 private:
     std::vector<Item> items;
+    QVector<uint> receivedChars;
 
     bool blockFurtherProcessing = false;
 
 public:
     void receiveChars(const QVector<uint> &c) override
     {
+        receivedChars += c;
         Vt102Emulation::receiveChars(c);
     }
 
@@ -11,7 +11,12 @@
 #include "LineBlockCharacters.h"
 
 // Qt
+#include <QCache>
+#include <QHashFunctions>
+#include <QImage>
+#include <QPaintDevice>
 #include <QPainterPath>
+#include <QPixmap>
 
 namespace Konsole
 {
@@ -839,7 +844,7 @@ static inline bool drawBrailleCharacter(QPainter &paint, int x, int y, int w, in
     return true;
 }
 
-void draw(QPainter &paint, const QRect &cellRect, const uint &chr, bool bold)
+static void drawUncached(QPainter &paint, const QRect &cellRect, const uint &chr, bool bold)
 {
     static const ushort FirstBoxDrawingCharacterCodePoint = 0x2500;
     static const ushort FirstBrailleCodePoint = 0x2800;
@@ -867,5 +872,87 @@ void draw(QPainter &paint, const QRect &cellRect, const uint &chr, bool bold)
         || drawBlockCharacter(paint, x, y, w, h, code, bold);
 }
 
+// Identifies a character rasterized into a pixmap
+struct GlyphKey {
+    uint chr;
+    int width;
+    int height;
+    int devicePixelRatio;
+    QRgb color;
+    bool bold;
+    bool antialias;
+
+    bool operator==(const GlyphKey &other) const
+    {
+        return chr == other.chr && width == other.width && height == other.height && devicePixelRatio == other.devicePixelRatio && color == other.color
+            && bold == other.bold && antialias == other.antialias;
+    }
+};
+
+static size_t qHash(const GlyphKey &key, size_t seed = 0)
+{
+    return qHashMulti(seed, key.chr, key.width, key.height, key.devicePixelRatio, key.color, key.bold, key.antialias);
+}
+
+// Returns true if the character looks the same when drawn into a pixmap at the
+// origin and copied into the cell
+static bool canCache(const QPainter &paint, uint chr)
+{
+    // the ends of diagonal lines stick out of the cell
+    if (chr >= 0x2571 && chr <= 0x2573) {
+        return false;
+    }
+    // pattern brushes are aligned to the painter's origin
+    if (chr >= 0x2591 && chr <= 0x2593 && !paint.testRenderHint(QPainter::Antialiasing)) {
+        return false;
+    }
+    // a pixmap can only be copied pixel for pixel to whole device pixels
+    const qreal devicePixelRatio = paint.device()->devicePixelRatioF();
+    return devicePixelRatio == qRound(devicePixelRatio) && paint.worldTransform().type() <= QTransform::TxTranslate;
+}
+
+void draw(QPainter &paint, const QRect &cellRect, const uint &chr, bool bold)
+{
+    if (!canCache(paint, chr)) {
+        drawUncached(paint, cellRect, chr, bold);
+        return;
+    }
+
+    // TUIs draw the same few characters in the same few colors over and over,
+    // so they are rasterized once and then only copied
+    static QCache<GlyphKey, QPixmap> cache(16 * 1024 * 1024);
+
+    const int devicePixelRatio = qRound(paint.device()->devicePixelRatioF());
+    const GlyphKey key = {chr,
+                          cellRect.width(),
+                          cellRect.height(),
+                          devicePixelRatio,
+                          paint.pen().color().rgba(),
+                          bold,
+                          paint.testRenderHint(QPainter::Antialiasing)};
+
+    QPixmap *pixmap = cache.object(key);
+    if (pixmap == nullptr) {
+        QImage image(cellRect.size() * devicePixelRatio, QImage::Format_ARGB32_Premultiplied);
+        image.setDevicePixelRatio(devicePixelRatio);
+        image.fill(Qt::transparent);
+
+        QPainter imagePainter(&image);
+        imagePainter.setRenderHint(QPainter::Antialiasing, key.antialias);
+        imagePainter.setPen(paint.pen());
+        drawUncached(imagePainter, QRect(QPoint(0, 0), cellRect.size()), chr, bold);
+        imagePainter.end();
+
+        const qsizetype cost = image.sizeInBytes();
+        pixmap = new QPixmap(QPixmap::fromImage(image));
+        if (!cache.insert(key, pixmap, cost)) {
+            drawUncached(paint, cellRect, chr, bold);
+            return;
+        }
+    }
+
+    paint.drawPixmap(cellRect.topLeft(), *pixmap);
+}
+
 } // namespace LineBlockCharacters
 } // namespace Konsole
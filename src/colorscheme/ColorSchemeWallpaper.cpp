@@ -34,6 +34,7 @@ ColorSchemeWallpaper::ColorSchemeWallpaper(const QString &path,
     , _flipType(flipType)
     , _isAnimated(false)
     , _frameDelay(17) // Approx. 60FPS
+    , _frames(64 * 1024 * 1024)
 {
     float x = _anchor.x(), y = _anchor.y();
 
@@ -110,27 +111,21 @@ bool ColorSchemeWallpaper::draw(QPainter &painter, const QRect& rect, qreal bgCo
     painter.fillRect(rect, backgroundColor);
     painter.setOpacity(_opacity);
 
-    if (_isAnimated) {
-        if (_movie->state() == QMovie::NotRunning) {
-            _movie->start();
-        }
-        if (_picture != nullptr) {
-            _picture.reset();
-        }
-        if (_picture == nullptr) {
-            _picture = std::make_unique<QPixmap>();
-        }
-        if (_picture->isNull()) {
-            QImage currentImage = _movie->currentImage();
-            const QImage transformed = FlipImage(currentImage, _flipType);
-            _picture->convertFromImage(transformed);
-        }
+    if (_isAnimated && _movie->state() == QMovie::NotRunning) {
+        _movie->start();
     }
+
+    const QPixmap &frame = scaledFrame(painter.viewport().size(), painter.device()->devicePixelRatioF());
     if (_style == Tile) {
-        painter.drawTiledPixmap(rect, *_picture, rect.topLeft());
+        painter.drawTiledPixmap(rect, frame, rect.topLeft());
     } else {
-        QRectF srcRect = ScaledRect(painter.viewport().size(), _picture->size(), rect);
-        painter.drawPixmap(rect, *_picture, srcRect);
+        // the frame is already scaled, so only copy the part which lies under rect
+        const QSize viewportSize = painter.viewport().size();
+        const QSizeF scaledSize = frame.deviceIndependentSize();
+        const qreal ratio = frame.devicePixelRatio();
+        const QPointF offset((scaledSize.width() - viewportSize.width()) * _anchor.x(), (scaledSize.height() - viewportSize.height()) * _anchor.y());
+        const QRectF srcRect((rect.x() + offset.x()) * ratio, (rect.y() + offset.y()) * ratio, rect.width() * ratio, rect.height() * ratio);
+        painter.drawPixmap(rect, frame, srcRect);
     }
 
     painter.restore();
@@ -163,24 +158,37 @@ qreal ColorSchemeWallpaper::opacity() const
     return _opacity;
 }
 
-QRectF ColorSchemeWallpaper::ScaledRect(const QSize &viewportSize, const QSize &pictureSize, const QRect &rect)
+const QPixmap &ColorSchemeWallpaper::scaledFrame(const QSize &viewportSize, qreal devicePixelRatio)
 {
-    QRectF scaledRect = QRectF();
-    QSize scaledSize = _style == NoScaling ? pictureSize : pictureSize.scaled(viewportSize, RatioMode());
-
-    double scaleX = pictureSize.width() / static_cast<double>(scaledSize.width());
-    double scaleY = pictureSize.height() / static_cast<double>(scaledSize.height());
-
-    double offsetX = (scaledSize.width() - viewportSize.width()) * _anchor.x();
-    double offsetY = (scaledSize.height() - viewportSize.height()) * _anchor.y();
-
-    scaledRect.setX((rect.x() + offsetX) * scaleX);
-    scaledRect.setY((rect.y() + offsetY) * scaleY);
+    // tiled and unscaled pictures are drawn as they are, whatever the viewport
+    const bool scaled = _style != Tile && _style != NoScaling;
+    const FrameKey key = {
+        _isAnimated ? _movie->currentFrameNumber() : 0,
+        scaled ? viewportSize : QSize(),
+        scaled ? devicePixelRatio : 1.0,
+    };
+    if (const QPixmap *frame = _frames.object(key)) {
+        return *frame;
+    }
+    if (_uncachedFrameKey == key) {
+        return _uncachedFrame;
+    }
 
-    scaledRect.setWidth(rect.width() * scaleX);
-    scaledRect.setHeight(rect.height() * scaleY);
+    QPixmap frame = _isAnimated ? QPixmap::fromImage(FlipImage(_movie->currentImage(), _flipType)) : *_picture;
+    if (scaled && !frame.isNull()) {
+        const QSize scaledSize = frame.size().scaled(viewportSize, RatioMode());
+        frame = frame.scaled(scaledSize * devicePixelRatio, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        frame.setDevicePixelRatio(devicePixelRatio);
+    }
 
-    return scaledRect;
+    const qsizetype cost = qsizetype(frame.width()) * frame.height() * 4;
+    auto *cachedFrame = new QPixmap(frame);
+    if (_frames.insert(key, cachedFrame, cost)) {
+        return *cachedFrame;
+    }
+    _uncachedFrame = frame;
+    _uncachedFrameKey = key;
+    return _uncachedFrame;
 }
 
 Qt::AspectRatioMode ColorSchemeWallpaper::RatioMode()
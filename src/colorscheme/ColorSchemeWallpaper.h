@@ -10,17 +10,20 @@
 #define COLORSCHEMEWALLPAPER_H
 // STD
 #include <memory>
+#include <optional>
 
 // Qt
+#include <QCache>
+#include <QHashFunctions>
 #include <QMetaType>
 #include <QMovie>
+#include <QPixmap>
 #include <QPointF>
 #include <QSharedData>
 
 // Konsole
 #include "../characters/CharacterColor.h"
 
-class QPixmap;
 class QPainter;
 
 namespace Konsole
@@ -93,7 +96,31 @@ private:
     bool _isAnimated;
     int _frameDelay;
 
-    QRectF ScaledRect(const QSize &viewportSize, const QSize &pictureSize, const QRect &rect);
+    // Identifies a frame of the wallpaper prepared for a viewport
+    struct FrameKey {
+        int frame;
+        QSize viewportSize;
+        qreal devicePixelRatio;
+
+        bool operator==(const FrameKey &other) const
+        {
+            return frame == other.frame && viewportSize == other.viewportSize && devicePixelRatio == other.devicePixelRatio;
+        }
+
+        friend size_t qHash(const FrameKey &key, size_t seed = 0)
+        {
+            return qHashMulti(seed, key.frame, key.viewportSize.width(), key.viewportSize.height(), key.devicePixelRatio);
+        }
+    };
+
+    // Frames flipped and scaled for the viewports they were drawn in.  The
+    // wallpaper is shared between displays, which may have different sizes.
+    QCache<FrameKey, QPixmap> _frames;
+    // The last frame too large for _frames, kept while it is drawn again
+    QPixmap _uncachedFrame;
+    std::optional<FrameKey> _uncachedFrameKey;
+
+    const QPixmap &scaledFrame(const QSize &viewportSize, qreal devicePixelRatio);
     Qt::AspectRatioMode RatioMode();
     QImage FlipImage(const QImage &image, const ColorSchemeWallpaper::FlipType flipType);
 };
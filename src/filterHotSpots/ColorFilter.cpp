@@ -10,6 +10,8 @@ using namespace Konsole;
 
 #include "ColorFilterHotSpot.h"
 
+#include <algorithm>
+
 // This matches:
 //   - an RGB-style string (e.g., #3e3, #feed) delimited by non-alphanumerics;
 //   - or, a sequence of ASCII characters (e.g., foobar, Aquamarine, TOMATO).
@@ -25,6 +27,30 @@ ColorFilter::ColorFilter()
     setRegExp(ColorRegExp);
 }
 
+bool ColorFilter::acceptMatch(const QRegularExpressionMatch &match) const
+{
+    const QStringView text = match.capturedView(1);
+
+    if (text.startsWith(QLatin1Char('#'))) {
+        // #RGB, #RRGGBB, #AARRGGBB, #RRRGGGBBB or #RRRRGGGGBBBB
+        const qsizetype digits = text.size() - 1;
+        return digits == 3 || digits == 6 || digits == 8 || digits == 9 || digits == 12;
+    }
+
+    // almost every word matches, but only a few of them are colors
+    const auto lessThan = [](QStringView a, QStringView b) {
+        return a.compare(b, Qt::CaseInsensitive) < 0;
+    };
+    static const QStringList colorNames = [lessThan]() {
+        QStringList names = QColor::colorNames();
+        names.append(QStringLiteral("transparent"));
+        std::sort(names.begin(), names.end(), lessThan);
+        return names;
+    }();
+
+    return std::binary_search(colorNames.cbegin(), colorNames.cend(), text, lessThan);
+}
+
 QSharedPointer<HotSpot> ColorFilter::newHotSpot(int startLine, int startColumn, int endLine, int endColumn, const QStringList &capturedTexts)
 {
     QColor color(capturedTexts.at(1));
@@ -20,6 +20,8 @@ public:
 
 protected:
     QSharedPointer<HotSpot> newHotSpot(int startLine, int startColumn, int endLine, int endColumn, const QStringList &capturedTexts) override;
+    /** Reimplemented to skip the words which are no color names, before they are given to QColor */
+    bool acceptMatch(const QRegularExpressionMatch &match) const override;
 };
 }
 
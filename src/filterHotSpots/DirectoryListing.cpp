@@ -0,0 +1,103 @@
+/*
+    SPDX-FileCopyrightText: 2026 Konsole Plus contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+// Own
+#include "DirectoryListing.h"
+
+// Qt
+#include <QCoreApplication>
+#include <QDir>
+#include <QHash>
+#include <QThreadPool>
+
+using namespace Konsole;
+
+// directory listings by path, only used by the GUI thread
+static QHash<QString, std::weak_ptr<DirectoryListing>> listings;
+
+std::shared_ptr<DirectoryListing> DirectoryListing::forPath(const QString &path)
+{
+    std::shared_ptr<DirectoryListing> listing = listings.value(path).lock();
+    if (!listing) {
+        listing.reset(new DirectoryListing(path));
+        listing->_self = listing;
+        listings.insert(path, listing);
+        listing->list();
+    }
+    return listing;
+}
+
+DirectoryListing::DirectoryListing(const QString &path)
+    : _path(path)
+{
+    _relistTimer.setSingleShot(true);
+    _relistTimer.setInterval(500);
+    connect(&_relistTimer, &QTimer::timeout, this, &DirectoryListing::list);
+
+    _watcher.addPath(path);
+    connect(&_watcher, &QFileSystemWatcher::directoryChanged, this, [this]() {
+        if (_listing) {
+            _changedWhileListing = true;
+        } else if (!_relistTimer.isActive()) {
+            _relistTimer.start();
+        }
+    });
+}
+
+DirectoryListing::~DirectoryListing()
+{
+    listings.remove(_path);
+}
+
+QString DirectoryListing::path() const
+{
+    return _path;
+}
+
+bool DirectoryListing::contains(const QString &name) const
+{
+    return _entries.contains(name);
+}
+
+int DirectoryListing::revision() const
+{
+    return _revision;
+}
+
+void DirectoryListing::list()
+{
+    _listing = true;
+    _changedWhileListing = false;
+
+    // the worker only holds a weak reference, so that a listing which is
+    // no longer used is destroyed on the GUI thread without waiting for it
+    QThreadPool::globalInstance()->start([path = _path, self = _self]() {
+        const QStringList names = QDir(path).entryList(QDir::Dirs | QDir::Files, QDir::NoSort);
+        const QSet<QString> entries(names.cbegin(), names.cend());
+
+        QMetaObject::invokeMethod(
+            QCoreApplication::instance(),
+            [self, entries]() {
+                if (std::shared_ptr<DirectoryListing> listing = self.lock()) {
+                    listing->setEntries(entries);
+                }
+            },
+            Qt::QueuedConnection);
+    });
+}
+
+void DirectoryListing::setEntries(const QSet<QString> &entries)
+{
+    _entries = entries;
+    _revision++;
+    _listing = false;
+
+    if (_changedWhileListing) {
+        _relistTimer.start();
+    }
+}
+
+#include "moc_DirectoryListing.cpp"
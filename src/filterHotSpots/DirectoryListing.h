@@ -0,0 +1,77 @@
+/*
+    SPDX-FileCopyrightText: 2026 Konsole Plus contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef DIRECTORYLISTING_H
+#define DIRECTORYLISTING_H
+
+#include <QFileSystemWatcher>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QTimer>
+
+#include <memory>
+
+#include "konsoleprivate_export.h"
+
+namespace Konsole
+{
+/**
+ * The names of the entries of a directory, as used by FileFilter to tell which
+ * words on the screen are files.
+ *
+ * The directory is listed on a worker thread, so that huge directories or slow
+ * network mounts don't block the terminal, and listed again when a
+ * QFileSystemWatcher reports changes.  Filters of sessions in the same directory
+ * share its listing.
+ */
+class KONSOLEPRIVATE_EXPORT DirectoryListing : public QObject
+{
+    Q_OBJECT
+
+public:
+    /** Returns the listing of the directory @p path, creating it if nobody uses it yet */
+    static std::shared_ptr<DirectoryListing> forPath(const QString &path);
+
+    ~DirectoryListing() override;
+
+    /** Returns the path of the directory */
+    QString path() const;
+
+    /**
+     * Returns true if the directory has an entry named @p name.  This is false
+     * for every name until the directory has been listed.
+     */
+    bool contains(const QString &name) const;
+
+    /** Returns a number which changes whenever the entries change */
+    int revision() const;
+
+private:
+    Q_DISABLE_COPY(DirectoryListing)
+
+    explicit DirectoryListing(const QString &path);
+
+    /** Lists the directory on a worker thread */
+    void list();
+    void setEntries(const QSet<QString> &entries);
+
+    QString _path;
+    QSet<QString> _entries;
+    int _revision = 0;
+    bool _listing = false;
+    // the directory changed while it was being listed
+    bool _changedWhileListing = false;
+    QFileSystemWatcher _watcher;
+    // a directory which keeps changing is listed at most once per interval
+    QTimer _relistTimer;
+
+    std::weak_ptr<DirectoryListing> _self;
+};
+
+}
+
+#endif
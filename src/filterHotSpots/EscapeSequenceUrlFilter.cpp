@@ -31,13 +31,9 @@ void EscapeSequenceUrlFilter::process()
         return;
     }
 
-    const auto urls = sWindow->screen()->urlExtractor()->history();
+    const auto urls = sWindow->screen()->urlExtractor()->urlsBetween(sWindow->currentLine(), sWindow->currentLine() + sWindow->windowLines());
 
     for (const auto &escapedUrl : urls) {
-        if (escapedUrl.begin.row < sWindow->currentLine() || escapedUrl.end.row > sWindow->currentLine() + sWindow->windowLines()) {
-            continue;
-        }
-
         const int beginRow = escapedUrl.begin.row - sWindow->currentLine();
         const int endRow = escapedUrl.end.row - sWindow->currentLine();
         QSharedPointer<HotSpot> spot(
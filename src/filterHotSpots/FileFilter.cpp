@@ -13,6 +13,7 @@
 #include "session/Session.h"
 #include "session/SessionManager.h"
 
+#include "DirectoryListing.h"
 #include "FileFilterHotspot.h"
 
 using namespace Konsole;
@@ -23,12 +24,13 @@ QRegularExpression FileFilter::_regex;
 FileFilter::FileFilter(Session *session, const QString &wordCharacters)
     : _session(session)
     , _dirPath(QString())
-    , _currentDirContents()
 {
     _regex = QRegularExpression(concatRegexPattern(wordCharacters), QRegularExpression::DontCaptureOption);
     setRegExp(_regex);
 }
 
+FileFilter::~FileFilter() = default;
+
 QString FileFilter::concatRegexPattern(QString wordCharacters) const
 {
     /* The wordCharacters can be a potentially broken regexp,
@@ -85,8 +87,29 @@ QSharedPointer<HotSpot> FileFilter::newHotSpot(int startLine, int startColumn, i
         return nullptr;
     }
 
-    const QString &filenameRef = capturedTexts.first();
-    QStringView filename = filenameRef;
+    const QStringView filename = fileName(capturedTexts.first());
+    if (filename.isEmpty()) {
+        return nullptr;
+    }
+
+    const bool absolute = filename.startsWith(QLatin1Char('/'));
+    return QSharedPointer<HotSpot>(new FileFilterHotSpot(startLine,
+                                                         startColumn,
+                                                         endLine,
+                                                         endColumn,
+                                                         capturedTexts,
+                                                         !absolute ? _dirPath + filename.toString() : filename.toString(),
+                                                         _session));
+}
+
+bool FileFilter::acceptMatch(const QRegularExpressionMatch &match) const
+{
+    return !fileName(match.capturedView()).isEmpty();
+}
+
+QStringView FileFilter::fileName(QStringView text) const
+{
+    QStringView filename = text;
     if (filename.startsWith(QLatin1Char('\'')) && filename.endsWith(QLatin1Char('\''))) {
         filename = filename.mid(1, filename.size() - 2);
     }
@@ -94,59 +117,60 @@ QSharedPointer<HotSpot> FileFilter::newHotSpot(int startLine, int startColumn, i
     // '.' and '..' could be valid hotspots, but '..................' most likely isn't
     static const QRegularExpression allDotRe{QRegularExpression::anchoredPattern(QStringLiteral("\\.{3}"))};
     if (allDotRe.match(filename).hasMatch()) {
-        return nullptr;
+        return {};
     }
 
     if (filename.startsWith(QLatin1String("[/"))) { // ctest error output
         filename = filename.mid(1);
     }
 
-    const bool absolute = filename.startsWith(QLatin1Char('/'));
-    if (!absolute) {
-        auto match = std::find_if(_currentDirContents.cbegin(), _currentDirContents.cend(), [filename](const QString &s) {
-            // early out if first char doesn't match
-            if (!s.isEmpty() && filename.at(0) != s.at(0)) {
-                return false;
-            }
-
-            const bool startsWith = filename.startsWith(s);
-            if (startsWith) {
-                // are we equal ?
-                if (filename.size() == s.size()) {
-                    return true;
-                }
-                int onePast = s.size();
-                if (onePast < filename.size()) {
-                    if (filename.at(onePast) == QLatin1Char(':') || filename.at(onePast) == QLatin1Char('/')) {
-                        return true;
-                    }
-                }
-            }
-            return false;
-        });
-
-        if (match == _currentDirContents.cend()) {
-            return nullptr;
+    if (filename.startsWith(QLatin1Char('/'))) {
+        return filename;
+    }
+
+    if (!_dirContents) {
+        return {};
+    }
+
+    // the filename is an entry of the directory, maybe followed by a path
+    // inside of it or by line numbers
+    if (_dirContents->contains(filename.toString())) {
+        return filename;
+    }
+    for (qsizetype i = 1; i < filename.size(); i++) {
+        if ((filename.at(i) == QLatin1Char(':') || filename.at(i) == QLatin1Char('/')) && _dirContents->contains(filename.left(i).toString())) {
+            return filename;
         }
     }
 
-    return QSharedPointer<HotSpot>(new FileFilterHotSpot(startLine,
-                                                         startColumn,
-                                                         endLine,
-                                                         endColumn,
-                                                         capturedTexts,
-                                                         !absolute ? _dirPath + filename.toString() : filename.toString(),
-                                                         _session));
+    return {};
 }
 
 void FileFilter::process()
 {
-    const QDir dir(_session->currentWorkingDirectory());
+    if (_session.isNull()) {
+        return;
+    }
+
     // Do not re-process.
-    if (_dirPath != dir.canonicalPath() + QLatin1Char('/')) {
-        _dirPath = dir.canonicalPath() + QLatin1Char('/');
+    const QString workingDirectory = _session->currentWorkingDirectory();
+    if (_workingDirectory != workingDirectory) {
+        _workingDirectory = workingDirectory;
+
+        const QString canonicalPath = QDir(workingDirectory).canonicalPath();
+        if (_dirPath != canonicalPath + QLatin1Char('/')) {
+            _dirPath = canonicalPath + QLatin1Char('/');
+            _dirContents = canonicalPath.isEmpty() ? nullptr : DirectoryListing::forPath(canonicalPath);
+            _dirContentsRevision = -1;
+        }
+    }
 
-        _currentDirContents = dir.entryList(QDir::Dirs | QDir::Files);
+    // the directory is listed in the background, and may change
+    const int revision = _dirContents ? _dirContents->revision() : 0;
+    if (_dirContentsRevision != revision) {
+        _dirContentsRevision = revision;
+        // names which were files may not be anymore, and the other way around
+        invalidate();
     }
 
     RegExpFilter::process();
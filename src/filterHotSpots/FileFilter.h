@@ -11,12 +11,15 @@
 #include <QPointer>
 #include <QString>
 
+#include <memory>
+
 #include "RegExpFilter.h"
 
 namespace Konsole
 {
 class Session;
 class HotSpot;
+class DirectoryListing;
 
 /**
  * A filter which matches files according to POSIX Portable Filename Character Set
@@ -27,6 +30,7 @@ class KONSOLEPRIVATE_EXPORT FileFilter : public RegExpFilter
 {
 public:
     explicit FileFilter(Session *session, const QString &wordCharacters);
+    ~FileFilter() override;
 
     void process() override;
 
@@ -34,13 +38,19 @@ public:
 
 protected:
     QSharedPointer<HotSpot> newHotSpot(int, int, int, int, const QStringList &) override;
+    bool acceptMatch(const QRegularExpressionMatch &match) const override;
 
 private:
     QString concatRegexPattern(QString wordCharacters) const;
+    /** Returns the name of the file in @p text, a match of the regular expression, or an empty view if it doesn't name a file */
+    QStringView fileName(QStringView text) const;
 
     QPointer<Session> _session;
+    // the working directory as reported by the session, and canonicalized
+    QString _workingDirectory;
     QString _dirPath;
-    QList<QString> _currentDirContents;
+    std::shared_ptr<DirectoryListing> _dirContents;
+    int _dirContentsRevision = 0;
     static QRegularExpression _regex;
 };
 
@@ -11,9 +11,16 @@
 
 using namespace Konsole;
 
+static quint64 nextGeneration()
+{
+    static quint64 generation = 0;
+    return ++generation;
+}
+
 Filter::Filter()
     : _linePositions(nullptr)
     , _buffer(nullptr)
+    , _generation(nextGeneration())
 {
 }
 
@@ -34,6 +41,21 @@ void Filter::setBuffer(const QString *buffer, const QList<int> *linePositions)
     _linePositions = linePositions;
 }
 
+bool Filter::isLineLocal() const
+{
+    return false;
+}
+
+quint64 Filter::generation() const
+{
+    return _generation;
+}
+
+void Filter::invalidate()
+{
+    _generation = nextGeneration();
+}
+
 std::pair<int, int> Filter::getLineColumn(int prevline, int position)
 {
     Q_ASSERT(_linePositions);
@@ -30,6 +30,7 @@ namespace Konsole
 {
 class Session;
 class HotSpot;
+class TerminalImageFilterChain;
 
 /**
  * A filter processes blocks of text looking for certain patterns (such as URLs or keywords from a list)
@@ -78,9 +79,26 @@ public:
      */
     void setBuffer(const QString *buffer, const QList<int> *linePositions);
 
+    /**
+     * Returns true if the hotspots the filter finds never span a line break which
+     * is not wrapped, and only depend on the text of the lines they cover.
+     *
+     * The hotspots of such filters are kept for the lines which didn't change since
+     * the last time the text was processed.  The base implementation returns false.
+     */
+    virtual bool isLineLocal() const;
+
+    /**
+     * Returns a number which changes whenever the filter may find other hotspots in
+     * the same text, e.g. because its pattern changed.  No two filters share a number.
+     */
+    quint64 generation() const;
+
 protected:
     /** Adds a new hotspot to the list */
     void addHotSpot(QSharedPointer<HotSpot> spot);
+    /** Changes generation(), to be called when the hotspots found in a text may change */
+    void invalidate();
     /** Returns the internal buffer */
     const QString *buffer();
     /** Converts a character position within buffer() to a line and column */
@@ -89,11 +107,15 @@ protected:
 private:
     Q_DISABLE_COPY(Filter)
 
+    // moves the hotspots it keeps for unchanged lines into the filter
+    friend class TerminalImageFilterChain;
+
     QMultiHash<int, QSharedPointer<HotSpot>> _hotspots;
     QList<QSharedPointer<HotSpot>> _hotspotList;
 
     const QList<int> *_linePositions;
     const QString *_buffer;
+    quint64 _generation;
 };
 
 } // namespace Konsole
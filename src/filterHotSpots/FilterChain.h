@@ -60,7 +60,7 @@ public:
     /**
      * Processes each filter in the chain
      */
-    void process();
+    virtual void process();
 
     /** Sets the buffer for each filter in the chain to process. */
     void setBuffer(const QString *buffer, const QList<int> *linePositions);
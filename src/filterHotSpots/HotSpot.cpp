@@ -57,6 +57,12 @@ int HotSpot::endColumn() const
     return _endColumn;
 }
 
+void HotSpot::moveLines(int lines)
+{
+    _startLine += lines;
+    _endLine += lines;
+}
+
 HotSpot::Type HotSpot::type() const
 {
     return _type;
@@ -76,6 +76,8 @@ public:
     int startColumn() const;
     /** Returns the column on endLine() where the hotspot area ends */
     int endColumn() const;
+    /** Moves the hotspot area down by @p lines lines, or up if @p lines is negative */
+    void moveLines(int lines);
     /**
      * Returns the type of the hotspot.  This is usually used as a hint for views on how to represent
      * the hotspot graphically.  eg.  Link hotspots are typically underlined when the user mouses over them
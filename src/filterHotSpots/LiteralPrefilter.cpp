@@ -0,0 +1,721 @@
+/*
+    SPDX-FileCopyrightText: 2026 Konsole Plus contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "LiteralPrefilter.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace Konsole;
+
+namespace
+{
+// Sets of literals larger than this are not worth searching for
+constexpr int MAX_LITERALS = 16;
+
+// What is known about the text matched by a part of a pattern
+struct Literals {
+    // if true, the part matches exactly one of strings; otherwise every
+    // match contains one of strings, or nothing is known if it is empty
+    bool exact = false;
+    QStringList strings;
+};
+
+Literals anything()
+{
+    return Literals();
+}
+
+Literals exactly(const QStringList &strings)
+{
+    return Literals{true, strings};
+}
+
+// Returns the strings of which every match of @p literals contains one,
+// or an empty list if there are none
+QStringList required(const Literals &literals)
+{
+    if (literals.strings.contains(QString())) {
+        return QStringList();
+    }
+    return literals.strings;
+}
+
+// Returns true if searching for @p a rules out more text than searching for @p b
+bool isBetter(const QStringList &a, const QStringList &b)
+{
+    if (b.isEmpty()) {
+        return true;
+    }
+
+    auto shortest = [](const QStringList &strings) {
+        qsizetype length = std::numeric_limits<qsizetype>::max();
+        for (const QString &string : strings) {
+            length = std::min(length, string.size());
+        }
+        return length;
+    };
+    const qsizetype lengthA = shortest(a);
+    const qsizetype lengthB = shortest(b);
+    return lengthA > lengthB || (lengthA == lengthB && a.size() < b.size());
+}
+
+/**
+ * A parser for the subset of the PCRE2 syntax which is common in search and
+ * hotspot patterns.  parse() fails on anything else.
+ */
+class PatternParser
+{
+public:
+    PatternParser(const QString &pattern, bool dotMatchesNewline)
+        : _pattern(pattern)
+        , _dotMatchesNewline(dotMatchesNewline)
+    {
+    }
+
+    bool parse(Literals *result)
+    {
+        return parseAlternation(result) && _pos == _pattern.size();
+    }
+
+    // some match may contain a line break
+    bool canMatchNewline = false;
+    // the pattern contains assertions about the start or the end of the text
+    bool hasAnchors = false;
+
+private:
+    bool atEnd() const
+    {
+        return _pos >= _pattern.size();
+    }
+
+    static bool isAsciiLetterOrDigit(QChar c)
+    {
+        return c.unicode() < 128 && c.isLetterOrNumber();
+    }
+
+    QChar peek(int offset = 0) const
+    {
+        return _pos + offset < _pattern.size() ? _pattern.at(_pos + offset) : QChar();
+    }
+
+    bool parseAlternation(Literals *result)
+    {
+        QList<Literals> branches;
+        while (true) {
+            Literals branch;
+            if (!parseSequence(&branch)) {
+                return false;
+            }
+            branches.append(branch);
+            if (peek() != QLatin1Char('|')) {
+                break;
+            }
+            ++_pos;
+        }
+
+        if (branches.size() == 1) {
+            *result = branches.first();
+            return true;
+        }
+
+        bool allExact = true;
+        QStringList strings;
+        for (const Literals &branch : std::as_const(branches)) {
+            allExact = allExact && branch.exact;
+            const QStringList branchStrings = branch.exact ? branch.strings : required(branch);
+            if (branchStrings.isEmpty()) {
+                // the branch may match anything
+                *result = anything();
+                return true;
+            }
+            for (const QString &string : branchStrings) {
+                if (!strings.contains(string)) {
+                    strings.append(string);
+                }
+            }
+        }
+
+        if (strings.size() > MAX_LITERALS) {
+            *result = anything();
+        } else {
+            *result = Literals{allExact, strings};
+        }
+        return true;
+    }
+
+    bool parseSequence(Literals *result)
+    {
+        // the exact strings matched by the items parsed so far, or since the last
+        // item which isn't exact
+        QStringList current{QString()};
+        QStringList best;
+        bool allExact = true;
+
+        while (!atEnd() && peek() != QLatin1Char('|') && peek() != QLatin1Char(')')) {
+            Literals item;
+            if (!parseAtom(&item) || !parseQuantifier(&item)) {
+                return false;
+            }
+
+            if (item.exact && current.size() * item.strings.size() <= MAX_LITERALS) {
+                QStringList product;
+                for (const QString &prefix : std::as_const(current)) {
+                    for (const QString &suffix : std::as_const(item.strings)) {
+                        product.append(prefix + suffix);
+                    }
+                }
+                current = product;
+                continue;
+            }
+
+            allExact = false;
+            const QStringList currentRequired = required(exactly(current));
+            if (!currentRequired.isEmpty() && isBetter(currentRequired, best)) {
+                best = currentRequired;
+            }
+            const QStringList itemRequired = required(item);
+            if (!itemRequired.isEmpty() && isBetter(itemRequired, best)) {
+                best = itemRequired;
+            }
+            current = item.exact ? item.strings : QStringList{QString()};
+        }
+
+        if (allExact) {
+            *result = exactly(current);
+            return true;
+        }
+
+        const QStringList currentRequired = required(exactly(current));
+        if (!currentRequired.isEmpty() && isBetter(currentRequired, best)) {
+            best = currentRequired;
+        }
+        *result = Literals{false, best};
+        return true;
+    }
+
+    bool parseQuantifier(Literals *item)
+    {
+        int min;
+        int max;
+        const QChar c = peek();
+        if (c == QLatin1Char('?')) {
+            min = 0;
+            max = 1;
+            ++_pos;
+        } else if (c == QLatin1Char('*')) {
+            min = 0;
+            max = -1;
+            ++_pos;
+        } else if (c == QLatin1Char('+')) {
+            min = 1;
+            max = -1;
+            ++_pos;
+        } else if (c == QLatin1Char('{') && isRepeatCount()) {
+            ++_pos;
+            min = readNumber();
+            max = min;
+            if (peek() == QLatin1Char(',')) {
+                ++_pos;
+                max = peek().isDigit() ? readNumber() : -1;
+            }
+            ++_pos; // '}'
+        } else {
+            return true;
+        }
+
+        // lazy and possessive quantifiers match the same text
+        if (peek() == QLatin1Char('?') || peek() == QLatin1Char('+')) {
+            ++_pos;
+        }
+
+        if (min == 0 && max == 1 && item->exact && item->strings.size() < MAX_LITERALS) {
+            if (!item->strings.contains(QString())) {
+                item->strings.append(QString());
+            }
+        } else if (min == 0) {
+            *item = anything();
+        } else if (!(min == 1 && max == 1)) {
+            *item = Literals{false, required(*item)};
+        }
+        return true;
+    }
+
+    // Returns true if a repeat count like {2}, {2,} or {2,5} starts at the current position
+    bool isRepeatCount() const
+    {
+        int i = 1;
+        if (!peek(i).isDigit()) {
+            return false;
+        }
+        while (peek(i).isDigit()) {
+            ++i;
+        }
+        if (peek(i) == QLatin1Char(',')) {
+            ++i;
+            while (peek(i).isDigit()) {
+                ++i;
+            }
+        }
+        return peek(i) == QLatin1Char('}');
+    }
+
+    int readNumber()
+    {
+        int number = 0;
+        while (peek().isDigit()) {
+            number = std::min(number * 10 + peek().digitValue(), 65535);
+            ++_pos;
+        }
+        return number;
+    }
+
+    bool parseAtom(Literals *result)
+    {
+        const QChar c = peek();
+        if (c == QLatin1Char('{') && (isRepeatCount() || peek(1) == QLatin1Char(','))) {
+            // a quantifier without anything to repeat
+            return false;
+        }
+        ++_pos;
+
+        switch (c.unicode()) {
+        case '(':
+            return parseGroup(result);
+        case '[':
+            *result = anything();
+            return parseClass();
+        case '.':
+            canMatchNewline = canMatchNewline || _dotMatchesNewline;
+            *result = anything();
+            return true;
+        case '^':
+        case '$':
+            hasAnchors = true;
+            *result = exactly({QString()});
+            return true;
+        case '\\':
+            return parseEscape(result);
+        case '*':
+        case '+':
+        case '?':
+            return false;
+        case '\n':
+            canMatchNewline = true;
+            break;
+        default:
+            break;
+        }
+
+        QString literal(c);
+        if (c.isHighSurrogate() && peek().isLowSurrogate()) {
+            literal.append(peek());
+            ++_pos;
+        }
+        *result = exactly({literal});
+        return true;
+    }
+
+    bool parseGroup(Literals *result)
+    {
+        bool lookaround = false;
+        if (peek() == QLatin1Char('*')) {
+            // backtracking control verbs
+            return false;
+        }
+
+        if (peek() == QLatin1Char('?')) {
+            ++_pos;
+            const QChar c = peek();
+            if (c == QLatin1Char(':') || c == QLatin1Char('>') || c == QLatin1Char('|')) {
+                ++_pos;
+            } else if (c == QLatin1Char('=') || c == QLatin1Char('!')) {
+                ++_pos;
+                lookaround = true;
+            } else if (c == QLatin1Char('<') && (peek(1) == QLatin1Char('=') || peek(1) == QLatin1Char('!'))) {
+                _pos += 2;
+                lookaround = true;
+            } else if (c == QLatin1Char('<') || c == QLatin1Char('\'') || (c == QLatin1Char('P') && peek(1) == QLatin1Char('<'))) {
+                // named group
+                const QChar end = c == QLatin1Char('\'') ? QLatin1Char('\'') : QLatin1Char('>');
+                const qsizetype nameEnd = _pattern.indexOf(end, _pos + (c == QLatin1Char('P') ? 2 : 1));
+                if (nameEnd < 0) {
+                    return false;
+                }
+                _pos = nameEnd + 1;
+            } else if (c == QLatin1Char('#')) {
+                const qsizetype commentEnd = _pattern.indexOf(QLatin1Char(')'), _pos);
+                if (commentEnd < 0) {
+                    return false;
+                }
+                _pos = commentEnd + 1;
+                *result = exactly({QString()});
+                return true;
+            } else if (c == QLatin1Char('R') || c.isDigit() || ((c == QLatin1Char('-') || c == QLatin1Char('+')) && peek(1).isDigit())) {
+                // recursion into a group which has been, or will be, parsed
+                const qsizetype callEnd = _pattern.indexOf(QLatin1Char(')'), _pos);
+                if (callEnd < 0) {
+                    return false;
+                }
+                _pos = callEnd + 1;
+                *result = anything();
+                return true;
+            } else {
+                // option settings, conditionals and other rarely used groups
+                return false;
+            }
+        }
+
+        Literals group;
+        if (!parseAlternation(&group) || peek() != QLatin1Char(')')) {
+            return false;
+        }
+        ++_pos;
+
+        *result = lookaround ? exactly({QString()}) : group;
+        return true;
+    }
+
+    bool parseEscape(Literals *result)
+    {
+        if (atEnd()) {
+            return false;
+        }
+
+        const QChar c = peek();
+        ++_pos;
+
+        // only ASCII letters and digits have a meaning after a backslash
+        if (!isAsciiLetterOrDigit(c)) {
+            QString literal(c);
+            if (c.isHighSurrogate() && peek().isLowSurrogate()) {
+                literal.append(peek());
+                ++_pos;
+            }
+            if (c == QLatin1Char('\n')) {
+                canMatchNewline = true;
+            }
+            *result = exactly({literal});
+            return true;
+        }
+
+        switch (c.unicode()) {
+        case 'b':
+        case 'B':
+            *result = exactly({QString()});
+            return true;
+        case 'A':
+        case 'z':
+        case 'Z':
+        case 'G':
+            hasAnchors = true;
+            *result = exactly({QString()});
+            return true;
+        case 'd':
+        case 'w':
+        case 'h':
+        case 'S':
+        case 'V':
+        case 'N':
+            *result = anything();
+            return true;
+        case 'D':
+        case 'W':
+        case 's':
+        case 'H':
+        case 'v':
+        case 'R':
+        case 'X':
+            canMatchNewline = true;
+            *result = anything();
+            return true;
+        case 'n':
+            canMatchNewline = true;
+            *result = exactly({QStringLiteral("\n")});
+            return true;
+        case 'p':
+        case 'P': {
+            bool matchesNewline = false;
+            if (!parseProperty(c == QLatin1Char('P'), &matchesNewline)) {
+                return false;
+            }
+            canMatchNewline = canMatchNewline || matchesNewline;
+            *result = anything();
+            return true;
+        }
+        case 't':
+            *result = exactly({QStringLiteral("\t")});
+            return true;
+        case 'r':
+            *result = exactly({QStringLiteral("\r")});
+            return true;
+        case 'f':
+            *result = exactly({QStringLiteral("\f")});
+            return true;
+        case 'e':
+            *result = exactly({QStringLiteral("\x1b")});
+            return true;
+        case 'a':
+            *result = exactly({QStringLiteral("\a")});
+            return true;
+        default:
+            // code points, properties, back references, quoting ...
+            return false;
+        }
+    }
+
+    // Parses a character class, after its opening bracket
+    bool parseClass()
+    {
+        const bool negated = peek() == QLatin1Char('^');
+        if (negated) {
+            ++_pos;
+        }
+        _classHasNewline = false;
+
+        bool first = true;
+        while (!atEnd()) {
+            const QChar c = peek();
+            if (c == QLatin1Char(']') && !first) {
+                ++_pos;
+                // a negated class matches line breaks unless it lists them
+                canMatchNewline = canMatchNewline || negated != _classHasNewline;
+                return true;
+            }
+            first = false;
+
+            if (c == QLatin1Char('[') && peek(1) == QLatin1Char(':')) {
+                const qsizetype nameEnd = _pattern.indexOf(QLatin1String(":]"), _pos + 2);
+                if (nameEnd < 0) {
+                    return false;
+                }
+                const QStringView name = QStringView(_pattern).mid(_pos + 2, nameEnd - _pos - 2);
+                if (name.startsWith(QLatin1Char('^')) || name == QLatin1String("space") || name == QLatin1String("cntrl")) {
+                    _classHasNewline = true;
+                }
+                _pos = nameEnd + 2;
+                continue;
+            }
+
+            char32_t low;
+            if (!parseClassCharacter(&low)) {
+                return false;
+            }
+            char32_t high = low;
+            if (peek() == QLatin1Char('-') && peek(1) != QLatin1Char(']') && low != char32_t(-1)) {
+                ++_pos;
+                if (!parseClassCharacter(&high) || high == char32_t(-1)) {
+                    return false;
+                }
+            }
+            if (low != char32_t(-1) && low <= '\n' && '\n' <= high) {
+                _classHasNewline = true;
+            }
+        }
+        return false;
+    }
+
+    // Parses a member of a character class, setting @p c to -1 for escaped classes like \d
+    bool parseClassCharacter(char32_t *c)
+    {
+        QChar current = peek();
+        ++_pos;
+        if (current != QLatin1Char('\\')) {
+            if (current.isHighSurrogate() && peek().isLowSurrogate()) {
+                *c = QChar::surrogateToUcs4(current, peek());
+                ++_pos;
+            } else {
+                *c = current.unicode();
+            }
+            return true;
+        }
+
+        if (atEnd()) {
+            return false;
+        }
+        current = peek();
+        ++_pos;
+        if (!isAsciiLetterOrDigit(current)) {
+            if (current.isHighSurrogate() && peek().isLowSurrogate()) {
+                *c = QChar::surrogateToUcs4(current, peek());
+                ++_pos;
+            } else {
+                *c = current.unicode();
+            }
+            return true;
+        }
+
+        switch (current.unicode()) {
+        case 'd':
+        case 'w':
+        case 'h':
+        case 'S':
+        case 'V':
+            *c = char32_t(-1);
+            return true;
+        case 'D':
+        case 'W':
+        case 's':
+        case 'H':
+        case 'v':
+            _classHasNewline = true;
+            *c = char32_t(-1);
+            return true;
+        case 'p':
+        case 'P': {
+            bool matchesNewline = false;
+            if (!parseProperty(current == QLatin1Char('P'), &matchesNewline)) {
+                return false;
+            }
+            _classHasNewline = _classHasNewline || matchesNewline;
+            *c = char32_t(-1);
+            return true;
+        }
+        case 'n':
+            *c = '\n';
+            return true;
+        case 't':
+            *c = '\t';
+            return true;
+        case 'r':
+            *c = '\r';
+            return true;
+        case 'f':
+            *c = '\f';
+            return true;
+        case 'e':
+            *c = 0x1b;
+            return true;
+        case 'a':
+            *c = '\a';
+            return true;
+        case 'b':
+            *c = '\b';
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // Parses a Unicode property after \p or \P, like \pL or \p{Lu}
+    bool parseProperty(bool negated, bool *matchesNewline)
+    {
+        QStringView name;
+        if (peek() == QLatin1Char('{')) {
+            const qsizetype nameEnd = _pattern.indexOf(QLatin1Char('}'), _pos);
+            if (nameEnd < 0) {
+                return false;
+            }
+            name = QStringView(_pattern).mid(_pos + 1, nameEnd - _pos - 1);
+            _pos = nameEnd + 1;
+        } else if (!atEnd()) {
+            name = QStringView(_pattern).mid(_pos, 1);
+            ++_pos;
+        } else {
+            return false;
+        }
+
+        if (name.startsWith(QLatin1Char('^'))) {
+            negated = !negated;
+            name = name.mid(1);
+        }
+
+        // line breaks are control characters, so they are not letters, marks, numbers,
+        // punctuation or symbols, nor part of a script other than Common
+        const bool withoutNewline = !name.isEmpty()
+            && (QStringView(u"LMNPS").contains(name.front()) || name == QLatin1String("Xan") || name == QLatin1String("Xwd"));
+        *matchesNewline = negated || !withoutNewline;
+        return true;
+    }
+
+    const QString &_pattern;
+    const bool _dotMatchesNewline;
+    qsizetype _pos = 0;
+    // the character class being parsed contains line breaks
+    bool _classHasNewline = false;
+};
+}
+
+LiteralPrefilter::LiteralPrefilter(const QRegularExpression &regExp)
+{
+    const QRegularExpression::PatternOptions options = regExp.patternOptions();
+    if (!regExp.isValid() || (options & QRegularExpression::ExtendedPatternSyntaxOption)) {
+        return;
+    }
+
+    const QString pattern = regExp.pattern();
+    PatternParser parser(pattern, options & QRegularExpression::DotMatchesEverythingOption);
+    Literals literals;
+    if (!parser.parse(&literals)) {
+        return;
+    }
+
+    _literals = required(literals);
+    _caseSensitivity = (options & QRegularExpression::CaseInsensitiveOption) ? Qt::CaseInsensitive : Qt::CaseSensitive;
+    _singleLine = !parser.canMatchNewline && !parser.hasAnchors;
+}
+
+QStringList LiteralPrefilter::literals() const
+{
+    return _literals;
+}
+
+Qt::CaseSensitivity LiteralPrefilter::caseSensitivity() const
+{
+    return _caseSensitivity;
+}
+
+bool LiteralPrefilter::isSingleLine() const
+{
+    return _singleLine;
+}
+
+bool LiteralPrefilter::canFilter() const
+{
+    return _singleLine && !_literals.isEmpty();
+}
+
+QList<LiteralPrefilter::Span> LiteralPrefilter::candidateSpans(QStringView text) const
+{
+    if (!canFilter()) {
+        return {{0, text.size()}};
+    }
+
+    QList<Span> spans;
+
+    // the next occurrence of each literal, searched for again once it has been passed
+    QList<qsizetype> occurrences(_literals.size(), -2);
+    qsizetype position = 0;
+    while (position < text.size()) {
+        qsizetype found = -1;
+        for (int i = 0; i < _literals.size(); ++i) {
+            if (occurrences[i] != -1 && occurrences[i] < position) {
+                occurrences[i] = text.indexOf(_literals.at(i), position, _caseSensitivity);
+            }
+            if (occurrences[i] != -1 && (found == -1 || occurrences[i] < found)) {
+                found = occurrences[i];
+            }
+        }
+        if (found == -1) {
+            break;
+        }
+
+        const qsizetype lineStart = found == position ? position : std::max(position, text.lastIndexOf(QLatin1Char('\n'), found - 1) + 1);
+        qsizetype lineEnd = text.indexOf(QLatin1Char('\n'), found);
+        if (lineEnd == -1) {
+            lineEnd = text.size();
+        }
+
+        if (!spans.isEmpty() && spans.last().first + spans.last().second + 1 >= lineStart) {
+            spans.last().second = lineEnd - spans.last().first;
+        } else {
+            spans.append({lineStart, lineEnd - lineStart});
+        }
+        position = lineEnd + 1;
+    }
+
+    return spans;
+}
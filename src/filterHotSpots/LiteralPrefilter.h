@@ -0,0 +1,77 @@
+/*
+    SPDX-FileCopyrightText: 2026 Konsole Plus contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef LITERALPREFILTER_H
+#define LITERALPREFILTER_H
+
+#include <QList>
+#include <QRegularExpression>
+#include <QStringList>
+#include <QStringView>
+
+#include <utility>
+
+#include "konsoleprivate_export.h"
+
+namespace Konsole
+{
+/**
+ * Finds the parts of a text which may contain a match for a regular expression,
+ * so that the regular expression only has to run on those.
+ *
+ * The pattern is analyzed for required literals: strings of which every match
+ * contains at least one.  A line which contains none of them can't contain a
+ * match.  For example, every match of "(https?|ftp)://\\S+" contains "://", and
+ * every match of "colou?r" contains "color" or "colour".
+ *
+ * The analysis is conservative.  Patterns which use syntax it doesn't know, or
+ * which may match across or depend on line breaks, are not filtered.
+ */
+class KONSOLEPRIVATE_EXPORT LiteralPrefilter
+{
+public:
+    using Span = std::pair<qsizetype, qsizetype>;
+
+    LiteralPrefilter() = default;
+    explicit LiteralPrefilter(const QRegularExpression &regExp);
+
+    /**
+     * Returns the literals of which every match of the pattern contains at least one,
+     * or an empty list if the pattern has no such literals.
+     */
+    QStringList literals() const;
+
+    /** Returns whether the literals have to be compared case sensitively. */
+    Qt::CaseSensitivity caseSensitivity() const;
+
+    /**
+     * Returns true if the pattern can only match within a line, and matches the
+     * same within a line as within a text made of several lines.
+     */
+    bool isSingleLine() const;
+
+    /**
+     * Returns true if candidateSpans() can skip the lines of a text
+     * which contain none of literals().
+     */
+    bool canFilter() const;
+
+    /**
+     * Returns the parts of @p text which may contain matches, as pairs of start
+     * position and length, in ascending order.  The parts are made of whole lines,
+     * separated by '\n'.  If canFilter() is false, the whole text is returned.
+     */
+    QList<Span> candidateSpans(QStringView text) const;
+
+private:
+    QStringList _literals;
+    Qt::CaseSensitivity _caseSensitivity = Qt::CaseSensitive;
+    bool _singleLine = false;
+};
+
+}
+
+#endif
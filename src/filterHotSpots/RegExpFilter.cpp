@@ -20,6 +20,8 @@ void RegExpFilter::setRegExp(const QRegularExpression &regExp)
 {
     _searchText = regExp;
     _searchText.optimize();
+    _prefilter = LiteralPrefilter(_searchText);
+    invalidate();
 }
 
 QRegularExpression RegExpFilter::regExp() const
@@ -37,26 +39,43 @@ void RegExpFilter::process()
         return;
     }
 
-    QRegularExpressionMatchIterator iterator(_searchText.globalMatch(*text));
     int prevline = 0;
-    while (iterator.hasNext()) {
-        QRegularExpressionMatch match(iterator.next());
-        std::pair<int, int> start = getLineColumn(prevline, match.capturedStart());
-        prevline = start.first;
-        std::pair<int, int> end = getLineColumn(prevline, match.capturedEnd());
-        prevline = end.first;
+    const QList<LiteralPrefilter::Span> spans = _prefilter.candidateSpans(*text);
+    for (const auto &[spanStart, spanLength] : spans) {
+        QRegularExpressionMatchIterator iterator(_searchText.globalMatchView(QStringView(*text).mid(spanStart, spanLength)));
+        while (iterator.hasNext()) {
+            QRegularExpressionMatch match(iterator.next());
+            if (!acceptMatch(match)) {
+                continue;
+            }
 
-        QSharedPointer<HotSpot> spot(newHotSpot(start.first, start.second, end.first, end.second, match.capturedTexts()));
+            std::pair<int, int> start = getLineColumn(prevline, spanStart + match.capturedStart());
+            prevline = start.first;
+            std::pair<int, int> end = getLineColumn(prevline, spanStart + match.capturedEnd());
+            prevline = end.first;
 
-        if (spot == nullptr) {
-            continue;
-        }
+            QSharedPointer<HotSpot> spot(newHotSpot(start.first, start.second, end.first, end.second, match.capturedTexts()));
+
+            if (spot == nullptr) {
+                continue;
+            }
 
-        addHotSpot(spot);
+            addHotSpot(spot);
+        }
     }
 }
 
+bool RegExpFilter::isLineLocal() const
+{
+    return _prefilter.isSingleLine();
+}
+
 QSharedPointer<HotSpot> RegExpFilter::newHotSpot(int startLine, int startColumn, int endLine, int endColumn, const QStringList &capturedTexts)
 {
     return QSharedPointer<HotSpot>(new RegExpFilterHotSpot(startLine, startColumn, endLine, endColumn, capturedTexts));
 }
+
+bool RegExpFilter::acceptMatch(const QRegularExpressionMatch &) const
+{
+    return true;
+}
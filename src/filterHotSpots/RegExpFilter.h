@@ -9,6 +9,7 @@
 #define REGEXP_FILTER_H
 
 #include "Filter.h"
+#include "LiteralPrefilter.h"
 
 #include "konsoleprivate_export.h"
 #include <QRegularExpression>
@@ -44,10 +45,14 @@ public:
      * Reimplemented to search the filter's text buffer for text matching regExp()
      *
      * If regexp matches the empty string, then process() will return immediately
-     * without finding results.
+     * without finding results.  Lines which can't contain a match, as told by a
+     * LiteralPrefilter, are skipped.
      */
     void process() override;
 
+    /** Reimplemented to return true if the regular expression can only match within a line */
+    bool isLineLocal() const override;
+
 protected:
     /**
      * Called when a match for the regular expression is encountered.  Subclasses should reimplement this
@@ -55,8 +60,17 @@ protected:
      */
     virtual QSharedPointer<HotSpot> newHotSpot(int startLine, int startColumn, int endLine, int endColumn, const QStringList &capturedTexts);
 
+    /**
+     * Called for each match of the regular expression before its position is worked out
+     * and newHotSpot() is called.  Subclasses can reimplement this to cheaply skip the
+     * matches which newHotSpot() would not make a hotspot of.  The base implementation
+     * accepts every match.
+     */
+    virtual bool acceptMatch(const QRegularExpressionMatch &match) const;
+
 private:
     QRegularExpression _searchText;
+    LiteralPrefilter _prefilter;
 };
 
 }
@@ -7,23 +7,41 @@
 #include "TerminalImageFilterChain.h"
 #include "profile/Profile.h"
 
+#include <QMultiHash>
+#include <QSet>
 #include <QTextStream>
+#include <QVarLengthArray>
 
 #include "../decoders/PlainTextDecoder.h"
 
+#include "Filter.h"
+#include "HotSpot.h"
 #include "terminalDisplay/TerminalDisplay.h"
 
 using namespace Konsole;
 
 TerminalImageFilterChain::TerminalImageFilterChain(TerminalDisplay *terminalDisplay)
     : FilterChain(terminalDisplay)
-    , _buffer(nullptr)
-    , _linePositions(nullptr)
+    , _buffer(std::make_unique<QString>())
+    , _linePositions(std::make_unique<QList<int>>())
 {
 }
 
 TerminalImageFilterChain::~TerminalImageFilterChain() = default;
 
+size_t TerminalImageFilterChain::paragraphKey(const Character *characters, int lines, int columns, bool wrapped)
+{
+    // only what PlainTextDecoder looks at
+    QVarLengthArray<char32_t, 1024> cells;
+    cells.reserve(2 * lines * columns);
+    for (int i = 0; i < lines * columns; i++) {
+        cells.append(characters[i].character);
+        cells.append((characters[i].flags & EF_REAL) | (characters[i].rendition.f.extended << 1));
+    }
+
+    return qHashMulti(qHashBits(cells.constData(), cells.size() * sizeof(char32_t)), lines, columns, wrapped);
+}
+
 void TerminalImageFilterChain::setImage(const Character *const image, int lines, int columns, const QVector<LineProperty> &lineProperties)
 {
     if (_filters.empty()) {
@@ -33,27 +51,158 @@ void TerminalImageFilterChain::setImage(const Character *const image, int lines,
     // reset all filters and hotspots
     reset();
 
+    // each paragraph of the previous image can be taken by one paragraph of this image
+    QMultiHash<size_t, Paragraph> previous;
+    previous.reserve(_paragraphs.size());
+    for (Paragraph &paragraph : _paragraphs) {
+        previous.insert(paragraph.key, std::move(paragraph));
+    }
+    _paragraphs.clear();
+    _paragraphOfLine.clear();
+    _buffer->clear();
+    _linePositions->clear();
+
     PlainTextDecoder decoder;
 
-    // setup new shared buffers for the filters to process on
-    _buffer.reset(new QString());
-    _linePositions.reset(new QList<int>());
+    for (int first = 0; first < lines;) {
+        int last = first;
+        while (last + 1 < lines && (lineProperties.value(last, LineProperty()).flags.f.wrapped) != 0) {
+            last++;
+        }
+        const int count = last - first + 1;
+        const bool wrapped = (lineProperties.value(last, LineProperty()).flags.f.wrapped) != 0;
+        const Character *const characters = image + first * columns;
+        const size_t key = paragraphKey(characters, count, columns, wrapped);
+
+        Paragraph paragraph;
+        auto it = previous.find(key);
+        if (it != previous.end()) {
+            paragraph = std::move(it.value());
+            previous.erase(it);
+
+            // the lines may have been scrolled
+            const int moved = first - paragraph.firstLine;
+            if (moved != 0) {
+                for (const auto &spots : std::as_const(paragraph.hotSpots)) {
+                    for (const auto &spot : spots) {
+                        spot->moveLines(moved);
+                    }
+                }
+            }
+        } else {
+            paragraph.key = key;
+
+            QTextStream lineStream(&paragraph.text);
+            decoder.begin(&lineStream);
+            for (int i = 0; i < count; i++) {
+                paragraph.linePositions.append(paragraph.text.length());
+                decoder.decodeLine(characters + i * columns, columns, LineProperty());
+            }
+
+            // pretend that each non-wrapped line ends with a newline character.
+            // this prevents a link that occurs at the end of one line
+            // being treated as part of a link that occurs at the start of the next line
+            if (!wrapped) {
+                lineStream << QLatin1Char('\n');
+            }
+            decoder.end();
+        }
+        paragraph.firstLine = first;
+
+        for (int position : std::as_const(paragraph.linePositions)) {
+            _linePositions->append(_buffer->length() + position);
+        }
+        _buffer->append(paragraph.text);
+        _paragraphOfLine.insert(_paragraphOfLine.size(), count, int(_paragraphs.size()));
+        _paragraphs.append(std::move(paragraph));
+
+        first = last + 1;
+    }
 
     setBuffer(_buffer.get(), _linePositions.get());
+}
 
-    QTextStream lineStream(_buffer.get());
-    decoder.begin(&lineStream);
+void TerminalImageFilterChain::process()
+{
+    QSet<quint64> generations;
+    for (auto *filter : std::as_const(_filters)) {
+        if (filter->isLineLocal()) {
+            processLineLocal(filter, true);
+            generations.insert(filter->generation());
+        } else {
+            filter->process();
+        }
+    }
 
-    for (int i = 0; i < lines; i++) {
-        _linePositions->append(_buffer->length());
-        decoder.decodeLine(image + i * columns, columns, LineProperty());
+    // forget the hotspots of filters which were removed or changed
+    for (Paragraph &paragraph : _paragraphs) {
+        for (auto it = paragraph.hotSpots.begin(); it != paragraph.hotSpots.end();) {
+            if (generations.contains(it.key())) {
+                ++it;
+            } else {
+                it = paragraph.hotSpots.erase(it);
+            }
+        }
+    }
+}
+
+void TerminalImageFilterChain::processLineLocal(Filter *filter, bool retry)
+{
+    const quint64 generation = filter->generation();
+
+    // the text of the paragraphs which the filter didn't process yet, and the
+    // line in the image of each of its lines
+    QString text;
+    QList<int> linePositions;
+    QList<int> lines;
+    QList<int> processed;
+    for (int i = 0; i < _paragraphs.size(); i++) {
+        const Paragraph &paragraph = _paragraphs.at(i);
+        if (paragraph.hotSpots.contains(generation)) {
+            continue;
+        }
+
+        for (int j = 0; j < paragraph.linePositions.size(); j++) {
+            linePositions.append(text.length() + paragraph.linePositions.at(j));
+            lines.append(paragraph.firstLine + j);
+        }
+        text.append(paragraph.text);
+        processed.append(i);
+    }
+
+    // even without new text, as processing is where filters update their state
+    filter->setBuffer(&text, &linePositions);
+    filter->process();
+    filter->setBuffer(_buffer.get(), _linePositions.get());
+
+    if (filter->generation() != generation && retry) {
+        // the hotspots kept for the other lines are out of date, e.g. because
+        // FileFilter found another working directory
+        filter->reset();
+        processLineLocal(filter, false);
+        return;
+    }
+
+    const QList<QSharedPointer<HotSpot>> found = filter->hotSpots();
+    filter->reset();
+
+    for (int i : std::as_const(processed)) {
+        _paragraphs[i].hotSpots.insert(generation, {});
+    }
+    for (const auto &spot : found) {
+        if (spot->startLine() < 0 || spot->startLine() >= lines.size()) {
+            continue;
+        }
+
+        const int line = lines.at(spot->startLine());
+        spot->moveLines(line - spot->startLine());
+        _paragraphs[_paragraphOfLine.at(line)].hotSpots[generation].append(spot);
+    }
 
-        // pretend that each non-wrapped line ends with a newline character.
-        // this prevents a link that occurs at the end of one line
-        // being treated as part of a link that occurs at the start of the next line
-        if ((lineProperties.value(i, LineProperty()).flags.f.wrapped) == 0) {
-            lineStream << QLatin1Char('\n');
+    for (const Paragraph &paragraph : std::as_const(_paragraphs)) {
+        const auto spots = paragraph.hotSpots.value(generation);
+        for (const auto &spot : spots) {
+            filter->addHotSpot(spot);
         }
     }
-    decoder.end();
 }
@@ -8,6 +8,9 @@
 #ifndef TERMINAL_IMAGE_FILTER_CHAIN
 #define TERMINAL_IMAGE_FILTER_CHAIN
 
+#include <QHash>
+#include <QList>
+#include <QSharedPointer>
 #include <QString>
 #include <memory>
 
@@ -18,7 +21,13 @@ namespace Konsole
 {
 class TerminalDisplay;
 
-/** A filter chain which processes character images from terminal displays */
+/**
+ * A filter chain which processes character images from terminal displays
+ *
+ * The text and the hotspots of the lines of the previous image are kept, so that
+ * lines which are the same in the next image, though maybe scrolled, don't have
+ * to be decoded and matched again.
+ */
 class KONSOLEPRIVATE_EXPORT TerminalImageFilterChain : public FilterChain
 {
 public:
@@ -35,13 +44,41 @@ public:
      */
     void setImage(const Character *const image, int lines, int columns, const QVector<LineProperty> &lineProperties);
 
+    /**
+     * Reimplemented to only process the lines which changed since the previous image
+     * with the filters which allow it, see Filter::isLineLocal().
+     */
+    void process() override;
+
 private:
     Q_DISABLE_COPY(TerminalImageFilterChain)
 
+    /*
+     * Lines of the image which are each wrapped into the next one but the last,
+     * with their decoded text and the hotspots line-local filters found in them.
+     */
+    struct Paragraph {
+        // hash of the characters of the lines
+        size_t key = 0;
+        int firstLine = 0;
+        QString text;
+        // positions of the lines in text
+        QList<int> linePositions;
+        // hotspots by Filter::generation()
+        QHash<quint64, QList<QSharedPointer<HotSpot>>> hotSpots;
+    };
+
+    static size_t paragraphKey(const Character *characters, int lines, int columns, bool wrapped);
+    void processLineLocal(Filter *filter, bool retry);
+
     /* usually QStrings and QLists are not supposed to be in the heap, here we have a problem:
         we need a shared memory space between many filter objeccts, defined by this TerminalImage. */
     std::unique_ptr<QString> _buffer;
     std::unique_ptr<QList<int>> _linePositions;
+
+    QList<Paragraph> _paragraphs;
+    // index in _paragraphs of each line of the image
+    QList<int> _paragraphOfLine;
 };
 
 }
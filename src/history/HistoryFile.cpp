@@ -13,6 +13,7 @@
 #include "konsoledebug.h"
 
 // System
+#include <algorithm>
 #include <cerrno>
 #ifndef Q_OS_WIN
 #include <unistd.h>
@@ -33,8 +34,8 @@ Q_GLOBAL_STATIC(QString, historyFileLocation)
 // History File ///////////////////////////////////////////
 HistoryFile::HistoryFile()
     : _length(0)
-    , _fileMap(nullptr)
-    , _readWriteBalance(0)
+    , _fileLength(0)
+    , _mapFailed(false)
 {
     // Determine the temp directory once
     // This class is called 3 times for each "unlimited" scrollback.
@@ -104,63 +105,151 @@ HistoryFile::HistoryFile()
 
 HistoryFile::~HistoryFile()
 {
-    if (_fileMap != nullptr) {
-        unmap();
-    }
+    unmapAll();
 }
 
-// TODO:  Mapping the entire file in will cause problems if the history file becomes exceedingly large,
-//(ie. larger than available memory).  HistoryFile::map() should only map in sections of the file at a time,
-// to avoid this.
-void HistoryFile::map()
+uchar *HistoryFile::mapped(qint64 loc, qint64 &available)
 {
-    Q_ASSERT(_fileMap == nullptr);
+    if (_mapFailed) {
+        return nullptr;
+    }
+
+    const qint64 offset = loc - loc % WINDOW_SIZE;
+    for (auto it = _windows.begin(); it != _windows.end(); ++it) {
+        if (it->offset != offset) {
+            continue;
+        }
+        if (loc - offset >= it->size) {
+            // the window was mapped before the file grew past its end
+            _tmpFile.unmap(it->data);
+            _windows.erase(it);
+            break;
+        }
+        std::rotate(_windows.begin(), it, it + 1);
+        available = _windows.front().size - (loc - offset);
+        return _windows.front().data + (loc - offset);
+    }
 
-    if (_tmpFile.flush()) {
-        Q_ASSERT(_tmpFile.size() >= _length);
-        _fileMap = _tmpFile.map(0, _length);
+    if (_windows.size() == MAX_WINDOWS) {
+        _tmpFile.unmap(_windows.back().data);
+        _windows.pop_back();
     }
 
+    const qint64 size = qMin(WINDOW_SIZE, _fileLength - offset);
+    uchar *data = _tmpFile.map(offset, size);
     // if mmap'ing fails, fall back to the read-lseek combination
-    if (_fileMap == nullptr) {
-        _readWriteBalance = 0;
+    if (data == nullptr) {
         qCDebug(KonsoleDebug) << "mmap'ing history failed.  errno = " << errno;
+        _mapFailed = true;
+        unmapAll();
+        return nullptr;
     }
+
+    _windows.insert(_windows.begin(), {offset, size, data});
+    available = size - (loc - offset);
+    return data + (loc - offset);
 }
 
-void HistoryFile::unmap()
+void HistoryFile::unmapAll()
 {
-    Q_ASSERT(_fileMap != nullptr);
+    for (const Window &window : _windows) {
+        _tmpFile.unmap(window.data);
+    }
+    _windows.clear();
+}
+
+void HistoryFile::readFile(char *buffer, qint64 size, qint64 loc)
+{
+    while (size > 0) {
+        qint64 available = 0;
+        const uchar *data = mapped(loc, available);
+        if (data == nullptr) {
+            if (!_tmpFile.seek(loc)) {
+                perror("HistoryFile::get.seek");
+                return;
+            }
+            if (_tmpFile.read(buffer, size) < 0) {
+                perror("HistoryFile::get.read");
+            }
+            return;
+        }
 
-    if (_tmpFile.unmap(_fileMap)) {
-        _fileMap = nullptr;
+        const qint64 n = qMin(size, available);
+        memcpy(buffer, data, n);
+        buffer += n;
+        loc += n;
+        size -= n;
     }
+}
+
+void HistoryFile::writeFile(const char *buffer, qint64 size, qint64 loc)
+{
+    while (size > 0) {
+        qint64 available = 0;
+        uchar *data = mapped(loc, available);
+        if (data == nullptr) {
+            if (!_tmpFile.seek(loc)) {
+                perror("HistoryFile::set.seek");
+                return;
+            }
+            if (_tmpFile.write(buffer, size) < 0) {
+                perror("HistoryFile::set.write");
+            }
+            _tmpFile.flush();
+            return;
+        }
 
-    Q_ASSERT(_fileMap == nullptr);
+        const qint64 n = qMin(size, available);
+        memcpy(data, buffer, n);
+        buffer += n;
+        loc += n;
+        size -= n;
+    }
 }
 
-void HistoryFile::add(const char *buffer, qint64 count)
+void HistoryFile::flush()
 {
-    if (_fileMap != nullptr) {
-        unmap();
+    if (_writeBuffer.isEmpty()) {
+        return;
     }
 
-    if (_readWriteBalance < INT_MAX) {
-        _readWriteBalance++;
+    if (!_tmpFile.seek(_fileLength)) {
+        perror("HistoryFile::add.seek");
+    } else if (_tmpFile.write(_writeBuffer.constData(), _writeBuffer.size()) != _writeBuffer.size() || !_tmpFile.flush()) {
+        perror("HistoryFile::add.write");
+    } else {
+        _fileLength += _writeBuffer.size();
     }
 
-    qint64 rc = 0;
+    // if writing failed, the buffered data is lost
+    _length = _fileLength;
+    _writeBuffer.resize(0);
+}
 
-    if (!_tmpFile.seek(_length)) {
+void HistoryFile::add(const char *buffer, qint64 count)
+{
+    if (_writeBuffer.size() + count > WRITE_BUFFER_SIZE) {
+        flush();
+    }
+
+    if (count < WRITE_BUFFER_SIZE) {
+        _writeBuffer.append(buffer, count);
+        _length += count;
+        return;
+    }
+
+    // too large to be worth buffering
+    if (!_tmpFile.seek(_fileLength)) {
         perror("HistoryFile::add.seek");
         return;
     }
-    rc = _tmpFile.write(buffer, count);
-    if (rc < 0) {
+    const qint64 rc = _tmpFile.write(buffer, count);
+    if (rc < 0 || !_tmpFile.flush()) {
         perror("HistoryFile::add.write");
         return;
     }
-    _length += rc;
+    _fileLength += rc;
+    _length = _fileLength;
 }
 
 void HistoryFile::get(char *buffer, qint64 size, qint64 loc)
@@ -170,31 +259,18 @@ void HistoryFile::get(char *buffer, qint64 size, qint64 loc)
         return;
     }
 
-    // count number of get() calls vs. number of add() calls.
-    // If there are many more get() calls compared with add()
-    // calls (decided by using MAP_THRESHOLD) then mmap the log
-    // file to improve performance.
-    if (_readWriteBalance > INT_MIN) {
-        _readWriteBalance--;
-    }
-    if ((_fileMap == nullptr) && _readWriteBalance < MAP_THRESHOLD) {
-        map();
-    }
-
-    if (_fileMap != nullptr) {
-        memcpy(buffer, _fileMap + loc, size);
-    } else {
-        qint64 rc = 0;
+    // what lies past the end of the data is left untouched
+    size = qMin(size, _length - loc);
 
-        if (!_tmpFile.seek(loc)) {
-            perror("HistoryFile::get.seek");
-            return;
-        }
-        rc = _tmpFile.read(buffer, size);
-        if (rc < 0) {
-            perror("HistoryFile::get.read");
-            return;
-        }
+    if (loc < _fileLength) {
+        const qint64 n = qMin(size, _fileLength - loc);
+        readFile(buffer, n, loc);
+        buffer += n;
+        loc += n;
+        size -= n;
+    }
+    if (size > 0) {
+        memcpy(buffer, _writeBuffer.constData() + (loc - _fileLength), size);
     }
 }
 
@@ -205,31 +281,18 @@ void HistoryFile::set(char *buffer, qint64 size, qint64 loc)
         return;
     }
 
-    // count number of get() calls vs. number of add() calls.
-    // If there are many more get() calls compared with add()
-    // calls (decided by using MAP_THRESHOLD) then mmap the log
-    // file to improve performance.
-    if (_readWriteBalance > INT_MIN) {
-        _readWriteBalance--;
-    }
-    if ((_fileMap == nullptr) && _readWriteBalance < MAP_THRESHOLD) {
-        map();
-    }
+    // what lies past the end of the data would be overwritten by the next add()
+    size = qMin(size, _length - loc);
 
-    if (_fileMap != nullptr) {
-        memcpy(_fileMap + loc, buffer, size);
-    } else {
-        qint64 rc = 0;
-
-        if (!_tmpFile.seek(loc)) {
-            perror("HistoryFile::set.seek");
-            return;
-        }
-        rc = _tmpFile.write(buffer, size);
-        if (rc < 0) {
-            perror("HistoryFile::set.write");
-            return;
-        }
+    if (loc < _fileLength) {
+        const qint64 n = qMin(size, _fileLength - loc);
+        writeFile(buffer, n, loc);
+        buffer += n;
+        loc += n;
+        size -= n;
+    }
+    if (size > 0) {
+        memcpy(_writeBuffer.data() + (loc - _fileLength), buffer, size);
     }
 }
 
@@ -239,6 +302,15 @@ void HistoryFile::removeLast(qint64 loc)
         fprintf(stderr, "removeLast(%lld): invalid args.\n", loc);
         return;
     }
+
+    if (loc >= _fileLength) {
+        _writeBuffer.resize(loc - _fileLength);
+    } else {
+        // the data after loc stays in the file until it is overwritten, the
+        // windows mapping it see the new data as they are shared mappings
+        _writeBuffer.resize(0);
+        _fileLength = loc;
+    }
     _length = loc;
 }
 
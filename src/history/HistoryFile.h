@@ -8,14 +8,23 @@
 #define HISTORYFILE_H
 
 // Qt
+#include <QByteArray>
 #include <QTemporaryFile>
 
+// STD
+#include <vector>
+
 #include "konsoleprivate_export.h"
 
 namespace Konsole
 {
 /*
    An extendable tmpfile(1) based buffer.
+
+   New data is collected in a write buffer and written to the file in large
+   blocks.  Reads are served from the write buffer or from fixed-size windows
+   of the file that are mapped on demand, so the file is never mapped as a
+   whole and appending data never unmaps it.
 */
 class HistoryFile
 {
@@ -29,26 +38,48 @@ public:
     virtual void removeLast(qint64 loc);
     virtual qint64 len() const;
 
-    // mmaps the file in read-only mode
-    void map();
-    // un-mmaps the file
-    void unmap();
+    // writes the buffered data to the file
+    void flush();
 
 private:
+    struct Window {
+        qint64 offset;
+        qint64 size;
+        uchar *data;
+    };
+
+    /**
+     * Returns the mapped address of @p loc, mapping the window that contains
+     * it if needed, or nullptr if mapping failed.  @p available is set to the
+     * number of mapped bytes from @p loc on.
+     */
+    uchar *mapped(qint64 loc, qint64 &available);
+
+    // un-mmaps all windows
+    void unmapAll();
+
+    // reads or writes @p size bytes of the part of the file written so far
+    void readFile(char *buffer, qint64 size, qint64 loc);
+    void writeFile(const char *buffer, qint64 size, qint64 loc);
+
     qint64 _length;
+    // the data up to _fileLength is in the file, the rest in _writeBuffer
+    qint64 _fileLength;
     QTemporaryFile _tmpFile;
 
-    // pointer to start of mmap'ed file data, or 0 if the file is not mmap'ed
-    uchar *_fileMap;
+    QByteArray _writeBuffer;
+
+    // mapped windows of the file, the most recently used first
+    std::vector<Window> _windows;
 
-    // incremented whenever 'add' is called and decremented whenever
-    //'get' is called.
-    // this is used to detect when a large number of lines are being read and processed from the history
-    // and automatically mmap the file for better performance (saves the overhead of many lseek-read calls).
-    int _readWriteBalance;
+    // set once mapping failed, after which the file is only read and written
+    bool _mapFailed;
 
-    // when _readWriteBalance goes below this threshold, the file will be mmap'ed automatically
-    static const int MAP_THRESHOLD = -1000;
+    // windows start at multiples of WINDOW_SIZE
+    static const qint64 WINDOW_SIZE = 4 * 1024 * 1024;
+    static const size_t MAX_WINDOWS = 8;
+    // the write buffer is written to the file when it would grow past this
+    static const qint64 WRITE_BUFFER_SIZE = 256 * 1024;
 };
 
 }
@@ -7,8 +7,15 @@
 // Own
 #include "HistoryScroll.h"
 
+#include "HistorySearchIndex.h"
 #include "HistoryType.h"
 
+// Qt
+#include <QVarLengthArray>
+
+// STD
+#include <limits>
+
 using namespace Konsole;
 
 HistoryScroll::HistoryScroll(HistoryType *t)
@@ -22,3 +29,68 @@ bool HistoryScroll::hasScroll() const
 {
     return true;
 }
+
+void HistoryScroll::setSearchIndexEnabled(bool enable)
+{
+    _searchIndexEnabled = enable;
+    if (!enable) {
+        invalidateSearchIndex();
+    }
+}
+
+bool HistoryScroll::isSearchIndexEnabled() const
+{
+    return _searchIndexEnabled;
+}
+
+bool HistoryScroll::searchCandidates(const QString &literal, QVector<std::pair<int, int>> *ranges)
+{
+    if (!_searchIndexEnabled) {
+        return false;
+    }
+
+    buildSearchIndex(std::numeric_limits<int>::max());
+    return _searchIndex->candidateLines(literal, ranges);
+}
+
+bool HistoryScroll::buildSearchIndex(int maxLines)
+{
+    if (!_searchIndexEnabled) {
+        return true;
+    }
+
+    // lines are indexed when the index is used rather than as they are
+    // added, so that the output isn't slowed down by the index
+    const int lines = getLines();
+    if (!_searchIndex || _searchIndex->lineCount() > lines) {
+        _searchIndex = std::make_unique<HistorySearchIndex>();
+    }
+    const int firstLine = _searchIndex->lineCount();
+    const int lastLine = lines - firstLine > maxLines ? firstLine + maxLines : lines;
+
+    QVarLengthArray<Character, 1024> cells;
+    for (int line = firstLine; line < lastLine; ++line) {
+        cells.resize(getLineLen(line));
+        getCells(line, 0, cells.size(), cells.data());
+        _searchIndex->addLine(cells.constData(), cells.size(), line > 0 && isWrappedLine(line - 1));
+    }
+    return lastLine == lines;
+}
+
+bool HistoryScroll::hasSearchIndex() const
+{
+    return _searchIndex && _searchIndex->lineCount() == getLines();
+}
+
+void HistoryScroll::indexRemovedLinesFromTop(int lines)
+{
+    // lines which weren't indexed yet may have been dropped as well
+    if (_searchIndex) {
+        _searchIndex->keepLastLines(_searchIndex->lineCount() - lines);
+    }
+}
+
+void HistoryScroll::invalidateSearchIndex()
+{
+    _searchIndex.reset();
+}
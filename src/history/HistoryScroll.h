@@ -9,6 +9,7 @@
 
 // STD
 #include <memory>
+#include <utility>
 
 #include "konsoleprivate_export.h"
 
@@ -16,6 +17,7 @@
 #include "../characters/Character.h"
 
 // Qt
+#include <QString>
 #include <QVector>
 
 namespace Konsole
@@ -24,6 +26,7 @@ namespace Konsole
 // Abstract base class for file and buffer versions
 //////////////////////////////////////////////////////////////////////
 class HistoryType;
+class HistorySearchIndex;
 
 class KONSOLEPRIVATE_EXPORT HistoryScroll
 {
@@ -58,6 +61,33 @@ public:
     virtual void removeCells() = 0;
     virtual int reflowLines(const int columns, std::map<int, int> *deltas = nullptr) = 0;
 
+    // search index
+    /**
+     * Enables or disables the search index.  Disabling it frees the index,
+     * which is otherwise kept until the history changes in a way it can't
+     * follow.
+     */
+    void setSearchIndexEnabled(bool enable);
+    bool isSearchIndexEnabled() const;
+    /**
+     * Stores the ranges of lines which may contain @p literal in @p ranges,
+     * as pairs of first and last line numbers.  The lines added since the
+     * index was last used are indexed here.
+     *
+     * Returns false if the search index is disabled or can't narrow down
+     * the lines, in which case all of them have to be searched.
+     */
+    bool searchCandidates(const QString &literal, QVector<std::pair<int, int>> *ranges);
+    /** Returns true if every line is indexed, so that searchCandidates() won't index any more. */
+    bool hasSearchIndex() const;
+    /**
+     * Indexes at most @p maxLines of the lines which aren't indexed yet,
+     * so that a large history can be indexed a piece at a time.
+     *
+     * Returns true once every line is indexed, or if the search index is disabled.
+     */
+    bool buildSearchIndex(int maxLines);
+
     //
     // FIXME:  Passing around constant references to HistoryType instances
     // is very unsafe, because those references will no longer
@@ -69,8 +99,19 @@ public:
     }
 
 protected:
+    // called by subclasses when @p lines lines are dropped from the top
+    void indexRemovedLinesFromTop(int lines);
+    // called by subclasses when lines change in any other way than
+    // being added or dropped from the top
+    void invalidateSearchIndex();
+
     std::unique_ptr<HistoryType> _historyType;
     const int MAX_REFLOW_LINES = 20000;
+
+private:
+    bool _searchIndexEnabled = false;
+    // the first lines of the history, which is caught up with the rest when used
+    std::unique_ptr<HistorySearchIndex> _searchIndex;
 };
 
 }
@@ -109,22 +109,25 @@ void HistoryScrollFile::removeCells()
     res = qMax(0, getLines() - 1);
     _index.removeLast(res * sizeof(qint64));
     _lineflags.removeLast(res * sizeof(LineProperty));
+
+    invalidateSearchIndex();
 }
 
 int Konsole::HistoryScrollFile::reflowLines(const int columns, std::map<int, int> *)
 {
-    auto reflowFile = std::make_unique<HistoryFile>();
-    reflowData newLine;
+    std::vector<qint64> newIndex;
+    std::vector<LineProperty> newLineFlags;
 
     auto reflowLineLen = [](qint64 start, qint64 end) {
         return (int)((end - start) / sizeof(Character));
     };
-    auto setNewLine = [](reflowData &change, qint64 index, LineProperty lineflag) {
-        change.index = index;
-        change.lineFlag = lineflag;
+    auto setNewLine = [&newIndex, &newLineFlags](qint64 index, LineProperty lineflag) {
+        newIndex.push_back(index);
+        newLineFlags.push_back(lineflag);
     };
 
-    // First all changes are saved on an auxiliary file, no real index is changed
+    // First all changes are kept in memory, no real index is changed.
+    // At most MAX_REFLOW_LINES are reflowed, so this stays small.
     int currentPos = 0;
     if (getLines() > MAX_REFLOW_LINES) {
         currentPos = getLines() - MAX_REFLOW_LINES;
@@ -144,13 +147,11 @@ int Konsole::HistoryScrollFile::reflowLines(const int columns, std::map<int, int
         while (reflowLineLen(startLine, endLine) > columns && !(lineProperty.flags.f.doubleheight_bottom | lineProperty.flags.f.doubleheight_top)) {
             startLine += (qint64)columns * sizeof(Character);
             lineProperty.flags.f.wrapped = 1;
-            setNewLine(newLine, startLine, lineProperty);
+            setNewLine(startLine, lineProperty);
             lineProperty.resetStarts();
-            reflowFile->add(reinterpret_cast<const char *>(&newLine), sizeof(reflowData));
         }
         lineProperty.flags.f.wrapped = 0;
-        setNewLine(newLine, endLine, lineProperty);
-        reflowFile->add(reinterpret_cast<const char *>(&newLine), sizeof(reflowData));
+        setNewLine(endLine, lineProperty);
         currentPos++;
     }
 
@@ -164,16 +165,10 @@ int Konsole::HistoryScrollFile::reflowLines(const int columns, std::map<int, int
         _lineflags.removeLast(0);
     }
 
-    // Now save the new indexes and properties to proper files
-    int totalLines = reflowFile->len() / sizeof(reflowData);
-    currentPos = 0;
-    while (currentPos < totalLines) {
-        reflowFile->get(reinterpret_cast<char *>(&newLine), sizeof(reflowData), currentPos * sizeof(reflowData));
-
-        _lineflags.add(reinterpret_cast<char *>(&newLine.lineFlag), sizeof(LineProperty));
-        _index.add(reinterpret_cast<char *>(&newLine.index), sizeof(qint64));
-        currentPos++;
-    }
+    // Now save the new indexes and properties to proper files, in one write each
+    _lineflags.add(reinterpret_cast<const char *>(newLineFlags.data()), newLineFlags.size() * sizeof(LineProperty));
+    _index.add(reinterpret_cast<const char *>(newIndex.data()), newIndex.size() * sizeof(qint64));
+    invalidateSearchIndex();
 
     return 0;
 }
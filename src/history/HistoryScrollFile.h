@@ -34,10 +34,11 @@ public:
     void setLineProperty(const int lineno, LineProperty prop) override;
 
     void addCells(const Character text[], const int count) override;
+    // the cells are copied into the write buffer of _cells either way
     void addCellsMove(Character text[], const int count) override
     {
         addCells(text, count);
-    } // TODO: optimize, if there's any point
+    }
     void addLine(LineProperty lineProperty = LineProperty()) override;
 
     // Modify history
@@ -50,11 +51,6 @@ private:
     mutable HistoryFile _index; // lines Row(qint64)
     mutable HistoryFile _cells; // text  Row(Character)
     mutable HistoryFile _lineflags; // flags Row(unsigned char)
-
-    struct reflowData { // data to reflow lines
-        qint64 index;
-        LineProperty lineFlag;
-    };
 };
 
 }
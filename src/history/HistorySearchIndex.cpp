@@ -0,0 +1,174 @@
+/*
+    SPDX-FileCopyrightText: 2026 Konsole Plus contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+// Own
+#include "HistorySearchIndex.h"
+
+// Konsole
+#include "../characters/ExtendedCharTable.h"
+
+// STD
+#include <algorithm>
+
+using namespace Konsole;
+
+int HistorySearchIndex::trigramBit(const char32_t *chars)
+{
+    quint32 hash = chars[0] * 0x9E3779B1U;
+    hash ^= chars[1] * 0x85EBCA77U;
+    hash ^= chars[2] * 0xC2B2AE3DU;
+    hash ^= hash >> 16;
+    hash *= 0x7FEB352DU;
+    hash ^= hash >> 15;
+    return static_cast<int>(hash % SIGNATURE_BITS);
+}
+
+void HistorySearchIndex::addCharacter(Block &block, char32_t c)
+{
+    if (_tailLength == 3) {
+        _tail[0] = _tail[1];
+        _tail[1] = _tail[2];
+        _tailLength = 2;
+    }
+    _tail[_tailLength++] = QChar::toCaseFolded(c);
+
+    if (_tailLength == 3) {
+        const int bit = trigramBit(_tail.data());
+        block.signature[bit / 64] |= quint64(1) << (bit % 64);
+    }
+}
+
+void HistorySearchIndex::addLine(const Character *cells, int count, bool continuesPrevious)
+{
+    continuesPrevious = continuesPrevious && _lineCount > 0;
+
+    if ((_firstLine + _lineCount) % BLOCK_LINES == 0) {
+        if (continuesPrevious) {
+            _blocks.back().wrapsIntoNext = true;
+        }
+        _blocks.emplace_back();
+    }
+
+    // a wrapped line continues the text of the previous one, so the trigrams
+    // across the line break belong to this line
+    if (!continuesPrevious) {
+        _tailLength = 0;
+    }
+
+    // index the characters PlainTextDecoder writes for the line, without decoding it
+    int realCharacterGuard = -1;
+    for (int i = count - 1; i >= 0; i--) {
+        if ((cells[i].flags & EF_REAL) != 0 && cells[i].character != '\n') {
+            realCharacterGuard = i;
+            break;
+        }
+    }
+
+    Block &block = _blocks.back();
+    for (int i = 0; i < count;) {
+        const Character &cell = cells[i];
+        if (cell.rendition.f.extended != 0) {
+            ushort extendedCharLength = 0;
+            const char32_t *chars = ExtendedCharTable::instance.lookupExtendedChar(cell.character, extendedCharLength);
+            if (chars != nullptr) {
+                for (ushort j = 0; j < extendedCharLength; j++) {
+                    addCharacter(block, chars[j]);
+                }
+                i += qMax(1, Character::stringWidth(chars, extendedCharLength));
+            } else {
+                ++i;
+            }
+        } else if (((cell.flags & EF_REAL) != 0 || i <= realCharacterGuard) && !cell.isRightHalfOfDoubleWide()) {
+            addCharacter(block, cell.character);
+            i += qMax(1, Character::stringWidth(&cell.character, 1));
+        } else {
+            ++i;
+        }
+    }
+
+    ++_lineCount;
+}
+
+void HistorySearchIndex::keepLastLines(int count)
+{
+    if (count >= _lineCount) {
+        return;
+    }
+
+    if (count <= 0) {
+        _blocks.clear();
+        _firstLine = 0;
+        _lineCount = 0;
+        _tailLength = 0;
+        return;
+    }
+
+    _firstLine += _lineCount - count;
+    _lineCount = count;
+    while (_firstLine >= BLOCK_LINES) {
+        _blocks.pop_front();
+        _firstLine -= BLOCK_LINES;
+    }
+}
+
+int HistorySearchIndex::lineCount() const
+{
+    return _lineCount;
+}
+
+bool HistorySearchIndex::candidateLines(const QString &literal, QVector<std::pair<int, int>> *ranges) const
+{
+    QVector<char32_t> folded;
+    const QList<uint> chars = literal.toUcs4();
+    for (const uint c : chars) {
+        folded.append(QChar::toCaseFolded(char32_t(c)));
+    }
+    if (folded.size() < 3) {
+        return false;
+    }
+
+    // checking more than 64 trigrams rarely rules out more blocks
+    QVector<int> bits;
+    for (int i = 0; i + 3 <= folded.size() && bits.size() < 64; ++i) {
+        const int bit = trigramBit(folded.constData() + i);
+        if (!bits.contains(bit)) {
+            bits.append(bit);
+        }
+    }
+    const quint64 allBits = bits.size() == 64 ? ~quint64(0) : (quint64(1) << bits.size()) - 1;
+
+    ranges->clear();
+    quint64 foundBits = 0;
+    int chainStart = 0;
+    for (int i = 0; i < int(_blocks.size()); ++i) {
+        const Block &block = _blocks[i];
+        for (int j = 0; j < bits.size(); ++j) {
+            if (block.signature[bits[j] / 64] & (quint64(1) << (bits[j] % 64))) {
+                foundBits |= quint64(1) << j;
+            }
+        }
+
+        // a literal may continue in the next block
+        if (block.wrapsIntoNext && i + 1 < int(_blocks.size())) {
+            continue;
+        }
+
+        if (foundBits == allBits) {
+            const int first = std::max(0, chainStart * BLOCK_LINES - _firstLine);
+            const int last = std::min(_lineCount - 1, (i + 1) * BLOCK_LINES - 1 - _firstLine);
+            if (!ranges->isEmpty() && ranges->last().second + 1 >= first) {
+                ranges->last().second = last;
+            } else {
+                ranges->append({first, last});
+            }
+        }
+
+        foundBits = 0;
+        chainStart = i + 1;
+    }
+
+    return true;
+}
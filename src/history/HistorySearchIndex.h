@@ -0,0 +1,92 @@
+/*
+    SPDX-FileCopyrightText: 2026 Konsole Plus contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef HISTORYSEARCHINDEX_H
+#define HISTORYSEARCHINDEX_H
+
+// STD
+#include <array>
+#include <deque>
+#include <utility>
+
+#include "konsoleprivate_export.h"
+
+// Konsole
+#include "../characters/Character.h"
+
+// Qt
+#include <QString>
+#include <QVector>
+
+namespace Konsole
+{
+/**
+ * A trigram index over the lines of a history scroll, used to skip the lines
+ * which can't contain a literal when searching.
+ *
+ * Lines are grouped into blocks of BLOCK_LINES lines.  Each block keeps a
+ * signature with one bit set for every trigram (three consecutive characters,
+ * case folded) which occurs in its lines, so a block which lacks the bit of
+ * one of a literal's trigrams can't contain the literal.  Trigrams spanning
+ * wrapped lines are included, and blocks joined by a wrapped line are checked
+ * together.
+ *
+ * The index only ever reports too many lines: bits are shared between trigrams
+ * and are not cleared when lines are removed.
+ */
+class KONSOLEPRIVATE_EXPORT HistorySearchIndex
+{
+public:
+    /** Number of lines summarized by a signature */
+    static constexpr int BLOCK_LINES = 32;
+
+    /**
+     * Adds a line at the end of the index.
+     *
+     * @param cells The cells of the line, which are read the way PlainTextDecoder does
+     * @param count The number of cells in the line
+     * @param continuesPrevious True if the previous line wraps into this one
+     */
+    void addLine(const Character *cells, int count, bool continuesPrevious);
+
+    /** Drops lines from the top of the index so that only the last @p count lines are kept. */
+    void keepLastLines(int count);
+
+    /** Returns the number of lines in the index. */
+    int lineCount() const;
+
+    /**
+     * Stores the ranges of lines which may contain @p literal in @p ranges,
+     * as pairs of first and last line numbers, in ascending order.
+     *
+     * Returns false if @p literal is too short to narrow down the lines.
+     */
+    bool candidateLines(const QString &literal, QVector<std::pair<int, int>> *ranges) const;
+
+private:
+    static constexpr int SIGNATURE_BITS = 4096;
+
+    struct Block {
+        std::array<quint64, SIGNATURE_BITS / 64> signature = {};
+        // the last line of the block wraps into the next block
+        bool wrapsIntoNext = false;
+    };
+
+    static int trigramBit(const char32_t *chars);
+    void addCharacter(Block &block, char32_t c);
+
+    std::deque<Block> _blocks;
+    // position of the first line in the first block
+    int _firstLine = 0;
+    int _lineCount = 0;
+    // the last three characters of the last line, case folded
+    std::array<char32_t, 3> _tail = {};
+    int _tailLength = 0;
+};
+
+}
+
+#endif
@@ -12,6 +12,11 @@ HistoryType::HistoryType() = default;
 
 HistoryType::~HistoryType() = default;
 
+bool HistoryType::isCompressed() const
+{
+    return false;
+}
+
 bool HistoryType::isUnlimited() const
 {
     return maximumLineCount() == -1;
@@ -23,6 +23,10 @@ public:
      * or false otherwise.
      */
     virtual bool isEnabled() const = 0;
+    /**
+     * Returns true if the older lines of history are kept compressed.
+     */
+    virtual bool isCompressed() const;
     /**
      * Returns the maximum number of lines which this history type
      * can store or -1 if the history can store an unlimited number of lines.
@@ -9,74 +9,402 @@
 #include "CompactHistoryScroll.h"
 #include "CompactHistoryType.h"
 
+// Qt
+#include <QVarLengthArray>
+
+// zlib
+#include <zlib.h>
+
+// Standard
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
 using namespace Konsole;
 
-CompactHistoryScroll::CompactHistoryScroll(const unsigned int maxLineCount)
-    : HistoryScroll(new CompactHistoryType(maxLineCount))
+CompactHistoryScroll::CompactHistoryScroll(const unsigned int maxLineCount, bool compressed)
+    : HistoryScroll(new CompactHistoryType(maxLineCount, compressed))
     , _maxLineCount(0)
 {
     setMaxNbLines(maxLineCount);
+    setCompressed(compressed);
+}
+
+// Number of unused chunks kept around for reuse, the rest is freed
+static const size_t MAX_FREE_CHUNKS = 16;
+
+// Bits of the format byte that starts each encoded line
+// The code points take four bytes instead of one
+static const quint8 LINE_WIDE = 1;
+// EF_ASCII_WORD is left out of the spans and derived from the code points
+static const quint8 LINE_ASCII_WORDS = 2;
+
+// A span is a cell count followed by the attributes shared by those cells
+static const size_t SPAN_SIZE = sizeof(quint32) + sizeof(RenditionFlagsC) + 2 * sizeof(CharacterColor) + sizeof(ExtraFlags);
+static const size_t LINE_HEADER_SIZE = sizeof(quint8) + sizeof(quint32);
+
+template<typename T>
+static inline char *store(char *data, const T &value)
+{
+    memcpy(data, &value, sizeof(T));
+    return data + sizeof(T);
+}
+
+template<typename T>
+static inline const char *load(const char *data, T &value)
+{
+    memcpy(&value, data, sizeof(T));
+    return data + sizeof(T);
+}
+
+// Matches how Screen sets EF_ASCII_WORD on the cells it displays
+static inline bool isAsciiWord(const char32_t c)
+{
+    return c > ' ' && c <= '~';
+}
+
+// Decodes @p count cells from @p startColumn of the encoded line at @p data
+static void decodeCells(const char *data, const int startColumn, const int count, Character buffer[])
+{
+    quint8 format;
+    quint32 spanCount;
+    const char *span = load(load(data, format), spanCount);
+    const char *codePoints = span + spanCount * SPAN_SIZE;
+    const bool asciiWords = format & LINE_ASCII_WORDS;
+
+    const int endColumn = startColumn + count;
+    int column = 0;
+    for (quint32 i = 0; i < spanCount && column < endColumn; ++i, span += SPAN_SIZE) {
+        quint32 run;
+        const char *attributes = load(span, run);
+        const int from = std::max(column, startColumn);
+        const int to = std::min(column + int(run), endColumn);
+        column += run;
+        if (from >= to) {
+            continue;
+        }
+
+        Character cell;
+        attributes = load(attributes, cell.rendition);
+        attributes = load(attributes, cell.foregroundColor);
+        attributes = load(attributes, cell.backgroundColor);
+        load(attributes, cell.flags);
+
+        for (int c = from; c < to; ++c) {
+            Character &destination = buffer[c - startColumn];
+            destination = cell;
+            if (format & LINE_WIDE) {
+                load(codePoints + c * sizeof(char32_t), destination.character);
+            } else {
+                destination.character = static_cast<uchar>(codePoints[c]);
+            }
+            if (asciiWords && isAsciiWord(destination.character)) {
+                destination.flags |= EF_ASCII_WORD;
+            }
+        }
+    }
 }
 
 void CompactHistoryScroll::removeLinesFromTop(size_t lines)
 {
-    if (_lineDatas.size() > 1) {
-        const unsigned int removing = _lineDatas.at(lines - 1).index;
-        _lineDatas.erase(_lineDatas.begin(), _lineDatas.begin() + lines);
+    indexRemovedLinesFromTop(int(std::min(lines, _lineCount)));
+    if (lines < _lineCount) {
+        _firstByte = lineData(lines - 1).index;
+        _lineHead = (_lineHead + lines) % _lineDatas.size();
+        _lineCount -= lines;
+    } else {
+        _firstByte = _endByte;
+        _lineHead = 0;
+        _lineCount = 0;
+    }
+    releaseUnusedChunks();
+}
+
+void CompactHistoryScroll::appendLineData(const LineData &data)
+{
+    if (_lineCount == _lineDatas.size()) {
+        // grow the circular buffer, unrolling it so that line 0 is at the start again
+        std::vector<LineData> grown;
+        grown.reserve(std::max<size_t>(64, _lineDatas.size() * 2));
+        for (size_t line = 0; line < _lineCount; ++line) {
+            grown.push_back(lineData(line));
+        }
+        grown.resize(grown.capacity());
+        _lineDatas = std::move(grown);
+        _lineHead = 0;
+    }
+
+    ++_lineCount;
+    lineData(_lineCount - 1) = data;
+}
+
+void CompactHistoryScroll::encodeLine(const Character cells[], const int count)
+{
+    quint8 format = LINE_ASCII_WORDS;
+    for (int i = 0; i < count; ++i) {
+        if (cells[i].character > 0xFF) {
+            format |= LINE_WIDE;
+        }
+        if (bool(cells[i].flags & EF_ASCII_WORD) != isAsciiWord(cells[i].character)) {
+            format &= ~LINE_ASCII_WORDS;
+        }
+    }
+    const ExtraFlags flagsMask = (format & LINE_ASCII_WORDS) ? ExtraFlags(~EF_ASCII_WORD) : ExtraFlags(~0);
+
+    _encodeBuffer.resize(LINE_HEADER_SIZE);
+    quint32 spanCount = 0;
+    for (int i = 0; i < count;) {
+        const Character &first = cells[i];
+        const ExtraFlags flags = first.flags & flagsMask;
+        int end = i + 1;
+        while (end < count && cells[end].rendition.all == first.rendition.all && cells[end].foregroundColor == first.foregroundColor
+               && cells[end].backgroundColor == first.backgroundColor && (cells[end].flags & flagsMask) == flags) {
+            ++end;
+        }
+
+        char span[SPAN_SIZE];
+        char *data = store(span, quint32(end - i));
+        data = store(data, first.rendition);
+        data = store(data, first.foregroundColor);
+        data = store(data, first.backgroundColor);
+        store(data, flags);
+        _encodeBuffer.insert(_encodeBuffer.end(), span, span + SPAN_SIZE);
 
-        _cells.erase(_cells.begin(), _cells.begin() + (removing - _indexBias));
-        _indexBias = removing;
+        ++spanCount;
+        i = end;
+    }
+    store(store(_encodeBuffer.data(), format), spanCount);
+
+    if (format & LINE_WIDE) {
+        size_t position = _encodeBuffer.size();
+        _encodeBuffer.resize(position + count * sizeof(char32_t));
+        for (int i = 0; i < count; ++i) {
+            store(_encodeBuffer.data() + position + i * sizeof(char32_t), cells[i].character);
+        }
     } else {
-        _lineDatas.clear();
-        _cells.clear();
+        for (int i = 0; i < count; ++i) {
+            _encodeBuffer.push_back(static_cast<char>(cells[i].character));
+        }
     }
 }
 
-void CompactHistoryScroll::addCells(const Character a[], const int count)
+void CompactHistoryScroll::appendBytes(const char *data, size_t size)
 {
-    _cells.insert(_cells.end(), a, a + count);
+    while (size > 0) {
+        const quint64 chunk = _endByte / CHUNK_SIZE - _firstChunk;
+        if (chunk == _chunks.size()) {
+            _chunks.push_back({newChunk(), QByteArray()});
+            if (_compressed && _chunks.size() > HOT_CHUNKS) {
+                compressChunk(_chunks[_chunks.size() - HOT_CHUNKS - 1]);
+            }
+        } else if (!_chunks[chunk].data) {
+            // removeCells() went back into a compressed chunk
+            decompressChunk(_chunks[chunk], _firstChunk + chunk);
+        }
 
-    // store the (biased) start of next line + default flag
-    // the flag is later updated when addLine is called
-    _lineDatas.push_back({static_cast<unsigned int>(_cells.size() + _indexBias), LineProperty()});
+        const quint64 offset = _endByte % CHUNK_SIZE;
+        const size_t n = std::min<size_t>(CHUNK_SIZE - offset, size);
+        memcpy(_chunks[chunk].data.get() + offset, data, n);
+        data += n;
+        size -= n;
+        _endByte += n;
+    }
+}
 
-    if (_lineDatas.size() > _maxLineCount + 5) {
-        removeLinesFromTop(5);
+void CompactHistoryScroll::readBytes(quint64 position, char *data, size_t size) const
+{
+    while (size > 0) {
+        const char *chunk = chunkData(position / CHUNK_SIZE);
+        const quint64 offset = position % CHUNK_SIZE;
+        const size_t n = std::min<size_t>(CHUNK_SIZE - offset, size);
+        memcpy(data, chunk + offset, n);
+        data += n;
+        size -= n;
+        position += n;
     }
 }
 
-void CompactHistoryScroll::addCellsMove(Character characters[], const int count)
+void CompactHistoryScroll::releaseUnusedChunks()
+{
+    // chunks that end before the first stored byte
+    while (!_chunks.empty() && (_firstChunk + 1) * CHUNK_SIZE <= _firstByte) {
+        recycleChunk(_chunks.front().data);
+        _chunks.pop_front();
+        ++_firstChunk;
+    }
+    // chunks that start after the last stored byte
+    while (!_chunks.empty() && (_firstChunk + _chunks.size() - 1) * CHUNK_SIZE >= _endByte) {
+        recycleChunk(_chunks.back().data);
+        _chunks.pop_back();
+    }
+    if (_chunks.empty()) {
+        _firstChunk = _firstByte / CHUNK_SIZE;
+    }
+
+    // the chunk numbers of released chunks get reused by removeCells()
+    _chunkCache.erase(std::remove_if(_chunkCache.begin(),
+                                     _chunkCache.end(),
+                                     [this](const CachedChunk &cached) {
+                                         return cached.number < _firstChunk || cached.number >= _firstChunk + _chunks.size();
+                                     }),
+                      _chunkCache.end());
+}
+
+CompactHistoryScroll::Chunk CompactHistoryScroll::newChunk()
+{
+    if (_freeChunks.empty()) {
+        return Chunk(new char[CHUNK_SIZE]);
+    }
+    Chunk chunk = std::move(_freeChunks.back());
+    _freeChunks.pop_back();
+    return chunk;
+}
+
+void CompactHistoryScroll::recycleChunk(Chunk &chunk)
+{
+    if (chunk && _freeChunks.size() < MAX_FREE_CHUNKS) {
+        _freeChunks.push_back(std::move(chunk));
+    }
+}
+
+void CompactHistoryScroll::compressChunk(StoredChunk &chunk)
+{
+    if (!chunk.data) {
+        return;
+    }
+
+    uLongf size = compressBound(CHUNK_SIZE);
+    QByteArray compressed(size, Qt::Uninitialized);
+    const int result = compress2(reinterpret_cast<Bytef *>(compressed.data()), &size, reinterpret_cast<const Bytef *>(chunk.data.get()), CHUNK_SIZE, Z_BEST_SPEED);
+    // Leave chunks that do not compress well as they are
+    if (result != Z_OK || size > CHUNK_SIZE - CHUNK_SIZE / 8) {
+        return;
+    }
+
+    compressed.resize(size);
+    compressed.squeeze();
+    chunk.compressed = compressed;
+    recycleChunk(chunk.data);
+    chunk.data.reset();
+}
+
+void CompactHistoryScroll::decompressChunk(StoredChunk &chunk, quint64 number)
+{
+    const char *data = chunkData(number);
+    Chunk decompressed = newChunk();
+    memcpy(decompressed.get(), data, CHUNK_SIZE);
+    chunk.data = std::move(decompressed);
+    chunk.compressed.clear();
+
+    _chunkCache.erase(std::remove_if(_chunkCache.begin(),
+                                     _chunkCache.end(),
+                                     [number](const CachedChunk &cached) {
+                                         return cached.number == number;
+                                     }),
+                      _chunkCache.end());
+}
+
+const char *CompactHistoryScroll::chunkData(quint64 number) const
+{
+    const StoredChunk &chunk = _chunks[number - _firstChunk];
+    if (chunk.data) {
+        return chunk.data.get();
+    }
+
+    auto cached = std::find_if(_chunkCache.begin(), _chunkCache.end(), [number](const CachedChunk &cached) {
+        return cached.number == number;
+    });
+    if (cached == _chunkCache.end()) {
+        Chunk data;
+        if (_chunkCache.size() < CHUNK_CACHE_SIZE) {
+            data.reset(new char[CHUNK_SIZE]);
+        } else {
+            // reuse the least recently used one
+            data = std::move(_chunkCache.back().data);
+            _chunkCache.pop_back();
+        }
+
+        uLongf size = CHUNK_SIZE;
+        const int result = uncompress(reinterpret_cast<Bytef *>(data.get()),
+                                      &size,
+                                      reinterpret_cast<const Bytef *>(chunk.compressed.constData()),
+                                      chunk.compressed.size());
+        Q_ASSERT(result == Z_OK && size == CHUNK_SIZE);
+        Q_UNUSED(result)
+
+        _chunkCache.insert(_chunkCache.begin(), {number, std::move(data)});
+    } else if (cached != _chunkCache.begin()) {
+        std::rotate(_chunkCache.begin(), cached, cached + 1);
+    }
+    return _chunkCache.front().data.get();
+}
+
+void CompactHistoryScroll::setCompressed(bool compressed)
+{
+    if (_compressed != compressed) {
+        _compressed = compressed;
+        for (size_t i = 0; i + HOT_CHUNKS < _chunks.size(); ++i) {
+            if (compressed) {
+                compressChunk(_chunks[i]);
+            } else if (!_chunks[i].data) {
+                decompressChunk(_chunks[i], _firstChunk + i);
+            }
+        }
+        if (!compressed) {
+            _chunkCache.clear();
+        }
+    }
+    updateHistoryType();
+}
+
+void CompactHistoryScroll::updateHistoryType()
 {
-    std::move(characters, characters + count, std::back_inserter(_cells));
+    auto *type = static_cast<CompactHistoryType *>(_historyType.get());
+    type->_maxLines = _maxLineCount;
+    type->_compressed = _compressed;
+}
 
-    // store the (biased) start of next line + default flag
+void CompactHistoryScroll::addCells(const Character a[], const int count)
+{
+    if (count > 0) {
+        encodeLine(a, count);
+        appendBytes(_encodeBuffer.data(), _encodeBuffer.size());
+    }
+
+    // store the start of next line + default flag
     // the flag is later updated when addLine is called
-    _lineDatas.push_back({static_cast<unsigned int>(_cells.size() + _indexBias), LineProperty()});
+    appendLineData({_endByte, count, LineProperty()});
 
-    if (_lineDatas.size() > _maxLineCount + 5) {
+    if (_lineCount > _maxLineCount + 5) {
         removeLinesFromTop(5);
     }
 }
 
+void CompactHistoryScroll::addCellsMove(Character characters[], const int count)
+{
+    // the cells are encoded, so there is nothing to gain from moving them
+    addCells(characters, count);
+}
+
 void CompactHistoryScroll::addLine(const LineProperty lineProperty)
 {
-    auto &flag = _lineDatas.back().flag;
+    auto &flag = lineData(_lineCount - 1).flag;
     flag = lineProperty;
 }
 
 int CompactHistoryScroll::getLines() const
 {
-    return _lineDatas.size();
+    return _lineCount;
 }
 
 int CompactHistoryScroll::getMaxLines() const
 {
-    return _maxLineCount;
+    return std::min<size_t>(_maxLineCount, std::numeric_limits<int>::max());
 }
 
 int CompactHistoryScroll::getLineLen(int lineNumber) const
 {
-    if (size_t(lineNumber) >= _lineDatas.size()) {
+    if (size_t(lineNumber) >= _lineCount) {
         return 0;
     }
 
@@ -88,112 +416,152 @@ void CompactHistoryScroll::getCells(const int lineNumber, const int startColumn,
     if (count == 0) {
         return;
     }
-    Q_ASSERT((size_t)lineNumber < _lineDatas.size());
+    Q_ASSERT((size_t)lineNumber < _lineCount);
 
     Q_ASSERT(startColumn >= 0);
     Q_ASSERT(startColumn <= lineLen(lineNumber) - count);
 
-    auto startCopy = _cells.begin() + startOfLine(lineNumber) + startColumn;
-    auto endCopy = startCopy + count;
-    std::copy(startCopy, endCopy, buffer);
+    const quint64 start = startOfLine(lineNumber);
+    const size_t size = lineData(lineNumber).index - start;
+    if (start / CHUNK_SIZE == (start + size - 1) / CHUNK_SIZE) {
+        decodeCells(chunkData(start / CHUNK_SIZE) + start % CHUNK_SIZE, startColumn, count, buffer);
+    } else {
+        // the line continues in the next chunk
+        QVarLengthArray<char, 1024> data(size);
+        readBytes(start, data.data(), size);
+        decodeCells(data.constData(), startColumn, count, buffer);
+    }
 }
 
-void CompactHistoryScroll::setMaxNbLines(const int lineCount)
+void CompactHistoryScroll::setMaxNbLines(const unsigned int lineCount)
 {
-    Q_ASSERT(lineCount >= 0);
     _maxLineCount = lineCount;
 
-    if (_lineDatas.size() > _maxLineCount) {
-        int linesToRemove = _lineDatas.size() - _maxLineCount;
+    if (_lineCount > _maxLineCount) {
+        int linesToRemove = _lineCount - _maxLineCount;
         removeLinesFromTop(linesToRemove);
     }
+    updateHistoryType();
 }
 
 void CompactHistoryScroll::removeCells()
 {
-    if (_lineDatas.size() > 1) {
+    if (_lineCount > 1) {
         /** Here we remove a line from the "end" of the buffers **/
 
-        // Get last line start
-        int lastLineStart = startOfLine(_lineDatas.size() - 1);
+        // the line content ends where the last line starts
+        _endByte = startOfLine(_lineCount - 1);
 
         // remove info about this line
-        _lineDatas.pop_back();
-
-        // remove the actual line content
-        _cells.erase(_cells.begin() + lastLineStart, _cells.end());
+        --_lineCount;
     } else {
-        _cells.clear();
-        _lineDatas.clear();
+        _endByte = _firstByte;
+        _lineHead = 0;
+        _lineCount = 0;
     }
+    releaseUnusedChunks();
+    invalidateSearchIndex();
 }
 
 bool CompactHistoryScroll::isWrappedLine(const int lineNumber) const
 {
-    Q_ASSERT((size_t)lineNumber < _lineDatas.size());
-    return (_lineDatas.at(lineNumber).flag.flags.f.wrapped) > 0;
+    Q_ASSERT((size_t)lineNumber < _lineCount);
+    return (lineData(lineNumber).flag.flags.f.wrapped) > 0;
 }
 
 LineProperty CompactHistoryScroll::getLineProperty(const int lineNumber) const
 {
-    Q_ASSERT((size_t)lineNumber < _lineDatas.size());
-    return _lineDatas.at(lineNumber).flag;
+    Q_ASSERT((size_t)lineNumber < _lineCount);
+    return lineData(lineNumber).flag;
 }
 
 void CompactHistoryScroll::setLineProperty(const int lineNumber, LineProperty prop)
 {
-    Q_ASSERT((size_t)lineNumber < _lineDatas.size());
-    _lineDatas.at(lineNumber).flag = prop;
+    Q_ASSERT((size_t)lineNumber < _lineCount);
+    lineData(lineNumber).flag = prop;
 }
 
 int CompactHistoryScroll::reflowLines(const int columns, std::map<int, int> *deltas)
 {
-    std::vector<LineData> newLineData;
+    // The encoded lines can't be split in place, so the reflowed lines are
+    // added to a new scroll while the processed ones are dropped from this
+    // one, which keeps the memory used close to that of a single copy.
+    CompactHistoryScroll reflowed(std::numeric_limits<int>::max(), _compressed);
+    reflowed._freeChunks = std::move(_freeChunks);
+    _freeChunks.clear();
 
-    auto reflowLineLen = [](int start, int end) {
-        return end - start;
-    };
-    auto setNewLine = [](std::vector<LineData> &change, unsigned int index, LineProperty flag) {
-        change.push_back({index, flag});
-    };
+    QVector<Character> cells;
+    std::vector<char> data;
 
+    const int totalLines = getLines();
     int currentPos = 0;
     int newPos = 0;
     int delta = 0;
-    while (currentPos < getLines()) {
-        int startLine = startOfLine(currentPos);
-        int endLine = startOfLine(currentPos + 1);
-        LineProperty lineProperty = getLineProperty(currentPos);
+    while (getLines() > 0) {
+        LineProperty lineProperty = getLineProperty(0);
+        const bool doubleHeight = lineProperty.flags.f.doubleheight_bottom | lineProperty.flags.f.doubleheight_top;
 
         // Join the lines if they are wrapped
-        while (currentPos < getLines() - 1 && isWrappedLine(currentPos)) {
-            currentPos++;
-            endLine = startOfLine(currentPos + 1);
+        int lines = 1;
+        int length = lineLen(0);
+        while (lines < getLines() && isWrappedLine(lines - 1)) {
+            length += lineLen(lines);
+            lines++;
         }
 
-        // Now reflow the lines
-        while (reflowLineLen(startLine, endLine) > columns && !(lineProperty.flags.f.doubleheight_bottom | lineProperty.flags.f.doubleheight_top)) {
-            startLine += columns;
-            lineProperty.flags.f.wrapped = 1;
-            setNewLine(newLineData, startLine + _indexBias, lineProperty);
-            lineProperty.resetStarts();
+        lineProperty.flags.f.wrapped = 0;
+        if (lines == 1 && (length <= columns || doubleHeight)) {
+            // The line stays as it is, copy its encoded data
+            data.resize(lineData(0).index - _firstByte);
+            readBytes(_firstByte, data.data(), data.size());
+            reflowed.appendBytes(data.data(), data.size());
+            reflowed.appendLineData({reflowed._endByte, length, lineProperty});
+            newPos++;
+        } else {
+            cells.resize(length);
+            for (int line = 0, column = 0; line < lines; column += lineLen(line), line++) {
+                getCells(line, 0, lineLen(line), cells.data() + column);
+            }
+
+            // Now reflow the lines
+            int start = 0;
+            while (length - start > columns && !doubleHeight) {
+                lineProperty.flags.f.wrapped = 1;
+                reflowed.addCells(cells.constData() + start, columns);
+                reflowed.addLine(lineProperty);
+                lineProperty.resetStarts();
+                start += columns;
+                newPos++;
+            }
+            lineProperty.flags.f.wrapped = 0;
+            reflowed.addCells(cells.constData() + start, length - start);
+            reflowed.addLine(lineProperty);
             newPos++;
         }
-        lineProperty.flags.f.wrapped = 0;
-        setNewLine(newLineData, endLine + _indexBias, lineProperty);
-        currentPos++;
-        newPos++;
+
+        removeLinesFromTop(lines);
+        currentPos += lines;
         if (deltas && delta != newPos - currentPos) {
-            (*deltas)[currentPos - getLines()] = newPos - currentPos - delta;
+            (*deltas)[currentPos - totalLines] = newPos - currentPos - delta;
             delta = newPos - currentPos;
         }
     }
-    _lineDatas = std::move(newLineData);
+
+    _chunks = std::move(reflowed._chunks);
+    _freeChunks = std::move(reflowed._freeChunks);
+    _firstChunk = reflowed._firstChunk;
+    _firstByte = reflowed._firstByte;
+    _endByte = reflowed._endByte;
+    _lineDatas = std::move(reflowed._lineDatas);
+    _lineHead = reflowed._lineHead;
+    _lineCount = reflowed._lineCount;
+    _chunkCache.clear();
+    invalidateSearchIndex();
 
     int deletedLines = 0;
-    size_t totalLines = getLines();
-    if (totalLines > _maxLineCount) {
-        deletedLines = totalLines - _maxLineCount;
+    size_t totalNewLines = getLines();
+    if (totalNewLines > _maxLineCount) {
+        deletedLines = totalNewLines - _maxLineCount;
         removeLinesFromTop(deletedLines);
     }
 
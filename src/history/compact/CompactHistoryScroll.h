@@ -10,7 +10,10 @@
 
 #include "history/HistoryScroll.h"
 #include "konsoleprivate_export.h"
+#include <QByteArray>
 #include <deque>
+#include <memory>
+#include <vector>
 
 namespace Konsole
 {
@@ -19,7 +22,7 @@ class KONSOLEPRIVATE_EXPORT CompactHistoryScroll final : public HistoryScroll
     typedef QVector<Character> TextLine;
 
 public:
-    explicit CompactHistoryScroll(const unsigned int maxLineCount = 1000);
+    explicit CompactHistoryScroll(const unsigned int maxLineCount = 1000, bool compressed = false);
     ~CompactHistoryScroll() override = default;
 
     int getLines() const override;
@@ -36,66 +39,186 @@ public:
 
     void removeCells() override;
 
-    void setMaxNbLines(const int lineCount);
+    void setMaxNbLines(const unsigned int lineCount);
+
+    /**
+     * Sets whether the older lines are kept compressed.
+     *
+     * When enabled, every chunk but the last HOT_CHUNKS ones is compressed
+     * with zlib as soon as it is full.  Compressed chunks are only
+     * decompressed, into a small cache, when getCells() reads from them.
+     */
+    void setCompressed(bool compressed);
 
     int reflowLines(const int columns, std::map<int, int> *deltas = nullptr) override;
 
 private:
     /**
-     * This is the actual buffer that contains the cells
+     * Lines are stored encoded, one after the other, in fixed-size chunks of
+     * bytes addressed by an absolute byte index that only ever grows: byte i
+     * lives in chunk i / CHUNK_SIZE at offset i % CHUNK_SIZE.  Dropping lines
+     * from the top only moves _firstByte forward and hands chunks that became
+     * unused to _freeChunks, so nothing is ever moved and both appending and
+     * dropping lines are O(1).
+     *
+     * A line is encoded as
+     *
+     *     quint8  format       LINE_WIDE, LINE_ASCII_WORDS
+     *     quint32 spanCount
+     *     spans               spanCount times: quint32 cell count, followed
+     *                          by the rendition, colors and flags shared by
+     *                          those cells
+     *     code points          one byte per cell, or four with LINE_WIDE
+     *
+     * Most lines only use one or two attribute sets and no code point above
+     * U+00FF, so a line takes a little more than a byte per cell instead of
+     * sizeof(Character).  Empty lines take no bytes at all.
+     */
+    static constexpr quint64 CHUNK_SIZE = 64 * 1024;
+    typedef std::unique_ptr<char[]> Chunk;
+
+    /**
+     * Holds either the bytes of a chunk or, once it has been compressed,
+     * the zlib data they were compressed to
      */
-    std::deque<Character> _cells;
+    struct StoredChunk {
+        Chunk data;
+        QByteArray compressed;
+    };
+    std::deque<StoredChunk> _chunks;
+    /**
+     * Chunks that are no longer used, kept to be reused by the next lines
+     */
+    std::vector<Chunk> _freeChunks;
+    // absolute number of the chunk at _chunks.front()
+    quint64 _firstChunk = 0;
+    // absolute index of the first byte of line 0
+    quint64 _firstByte = 0;
+    // absolute index one past the last stored byte
+    quint64 _endByte = 0;
 
     /**
-     * Each entry contains the start of the next line and the current line's
-     * properties.  The start of lines is biased by _indexBias, i.e. an index
-     * value of _indexBias corresponds to _cells' zero index.
-     *
-     * The use of a biased line start means we don't need to traverse the
-     * vector recalculating line starts when removing lines from the top, and
-     * also we don't need to traverse the vector to compute the start of a line
-     * as we would have to do if we stored line lengths.
+     * Each entry contains the absolute index of the start of the next line,
+     * the number of cells and the properties of the current line.
      *
-     * unsigned int means we're limited in common architectures to 4 million
-     * characters, but CompactHistoryScroll is limited by the UI to 1_000_000
-     * lines (see historyLineSpinner in src/widgets/HistorySizeWidget.ui), so
-     * enough for 1_000_000 lines of an average ~4295 length (and each
-     * Character takes 16 bytes, so that's 64Gb!).
+     * Storing the start of the next line instead of the encoded size means
+     * the data of any line is found without traversing the buffer, and the
+     * absolute indexes never need updating when lines are removed from the
+     * top.
      */
     struct LineData {
-        unsigned int index;
+        quint64 index;
+        int length;
         LineProperty flag;
     };
     /**
-     * This buffer contains the data about each line
-     * The size of this buffer is the number of lines we have.
+     * Circular buffer with the data about each line, line 0 is at _lineHead.
+     * The number of lines we have is _lineCount.
      */
     std::vector<LineData> _lineDatas;
-    unsigned int _indexBias = 0;
+    size_t _lineHead = 0;
+    size_t _lineCount = 0;
 
     /**
      * Max number of lines we can hold
      */
     size_t _maxLineCount;
 
+    // Number of chunks at the end that are never compressed
+    static constexpr size_t HOT_CHUNKS = 2;
+    // Number of decompressed chunks kept in _chunkCache
+    static constexpr size_t CHUNK_CACHE_SIZE = 4;
+
+    bool _compressed = false;
+
+    /**
+     * Decompressed copies of the most recently read compressed chunks,
+     * the most recently used first
+     */
+    struct CachedChunk {
+        quint64 number;
+        Chunk data;
+    };
+    mutable std::vector<CachedChunk> _chunkCache;
+
+    /**
+     * Reused by encodeLine() so that adding lines does not allocate
+     */
+    std::vector<char> _encodeBuffer;
+
     /**
      * Remove @p lines from the "start" of above buffers
      */
     void removeLinesFromTop(size_t lines);
 
+    void appendLineData(const LineData &data);
+
+    /**
+     * Encodes @p count cells into _encodeBuffer
+     */
+    void encodeLine(const Character cells[], const int count);
+
+    /**
+     * Appends @p size bytes to the chunks, adding chunks as needed
+     */
+    void appendBytes(const char *data, size_t size);
+
+    /**
+     * Copies @p size stored bytes starting at the absolute index @p position
+     */
+    void readBytes(quint64 position, char *data, size_t size) const;
+
+    /**
+     * Gives chunks that hold no stored byte back to _freeChunks
+     */
+    void releaseUnusedChunks();
+
+    /**
+     * Returns an empty chunk, reusing one from _freeChunks if possible
+     */
+    Chunk newChunk();
+
+    /**
+     * Keeps @p chunk in _freeChunks unless there are enough already
+     */
+    void recycleChunk(Chunk &chunk);
+
+    void compressChunk(StoredChunk &chunk);
+    void decompressChunk(StoredChunk &chunk, quint64 number);
+
+    /**
+     * Returns the bytes of chunk @p number, decompressing it into
+     * _chunkCache if needed.  The result stays valid until the next call.
+     */
+    const char *chunkData(quint64 number) const;
+
+    void updateHistoryType();
+
+    inline const LineData &lineData(const size_t line) const
+    {
+        const size_t i = _lineHead + line;
+        return _lineDatas[i < _lineDatas.size() ? i : i - _lineDatas.size()];
+    }
+
+    inline LineData &lineData(const size_t line)
+    {
+        const size_t i = _lineHead + line;
+        return _lineDatas[i < _lineDatas.size() ? i : i - _lineDatas.size()];
+    }
+
     inline int lineLen(const int line) const
     {
-        return line == 0 ? _lineDatas.at(0).index - _indexBias : _lineDatas.at(line).index - _lineDatas.at(line - 1).index;
+        return lineData(line).length;
     }
 
     /**
-     * Get the start of @p line in _cells buffer
+     * Get the absolute index of the start of the data of @p line
      *
      * index actually contains the start of the next line.
      */
-    inline int startOfLine(const int line) const
+    inline quint64 startOfLine(const int line) const
     {
-        return line == 0 ? 0 : _lineDatas.at(line - 1).index - _indexBias;
+        return line == 0 ? _firstByte : lineData(line - 1).index;
     }
 };
 
@@ -14,8 +14,9 @@ using namespace Konsole;
 // Reasonable line size
 static const int LINE_SIZE = 1024;
 
-CompactHistoryType::CompactHistoryType(unsigned int nbLines)
+CompactHistoryType::CompactHistoryType(unsigned int nbLines, bool compressed)
     : _maxLines(nbLines)
+    , _compressed(compressed)
 {
 }
 
@@ -24,22 +25,32 @@ bool CompactHistoryType::isEnabled() const
     return true;
 }
 
+bool CompactHistoryType::isCompressed() const
+{
+    return _compressed;
+}
+
 int CompactHistoryType::maximumLineCount() const
 {
-    return _maxLines;
+    return _maxLines == Unlimited ? -1 : int(_maxLines);
 }
 
 void CompactHistoryType::scroll(std::unique_ptr<HistoryScroll> &old) const
 {
+    // this type may belong to old, which changes it when updated
+    const unsigned int maxLines = _maxLines;
+    const bool compressed = _compressed;
+
     if (auto *newBuffer = dynamic_cast<CompactHistoryScroll *>(old.get())) {
-        newBuffer->setMaxNbLines(_maxLines);
+        newBuffer->setMaxNbLines(maxLines);
+        newBuffer->setCompressed(compressed);
         return;
     }
-    auto newScroll = std::make_unique<CompactHistoryScroll>(_maxLines);
+    auto newScroll = std::make_unique<CompactHistoryScroll>(maxLines, compressed);
 
     Character line[LINE_SIZE];
     int lines = (old != nullptr) ? old->getLines() : 0;
-    int i = qMax((lines - (int)_maxLines), 0);
+    int i = maxLines == Unlimited ? 0 : qMax((lines - (int)maxLines), 0);
     std::vector<Character> tmp_line;
     for (; i < lines; i++) {
         int size = old->getLineLen(i);
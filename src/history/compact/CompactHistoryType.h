@@ -10,20 +10,34 @@
 #include "history/HistoryType.h"
 #include "konsoleprivate_export.h"
 
+#include <limits>
+
 namespace Konsole
 {
 class KONSOLEPRIVATE_EXPORT CompactHistoryType : public HistoryType
 {
 public:
-    explicit CompactHistoryType(unsigned int nbLines);
+    /**
+     * Passing Unlimited as @p nbLines keeps every line; together with
+     * @p compressed this keeps unlimited scrollback in memory.
+     */
+    explicit CompactHistoryType(unsigned int nbLines, bool compressed = false);
+
+    static constexpr unsigned int Unlimited = std::numeric_limits<unsigned int>::max();
 
     bool isEnabled() const override;
+    bool isCompressed() const override;
     int maximumLineCount() const override;
 
     void scroll(std::unique_ptr<HistoryScroll> &) const override;
 
 protected:
+    // CompactHistoryScroll keeps its type up to date in place, so that
+    // references returned by getType() stay valid
+    friend class CompactHistoryScroll;
+
     unsigned int _maxLines;
+    bool _compressed;
 };
 
 }
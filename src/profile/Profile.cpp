@@ -121,6 +121,8 @@ const std::vector<Profile::PropertyInfo> Profile::DefaultProperties = {
     // Scrolling
     {HistoryMode, "HistoryMode", SCROLLING_GROUP, Enum::FixedSizeHistory},
     {HistorySize, "HistorySize", SCROLLING_GROUP, 1000},
+    {HistoryCompression, "HistoryCompression", SCROLLING_GROUP, false},
+    {HistorySearchIndex, "HistorySearchIndex", SCROLLING_GROUP, false},
     {ScrollBarPosition, "ScrollBarPosition", SCROLLING_GROUP, Enum::ScrollBarRight},
     {ScrollFullPage, "ScrollFullPage", SCROLLING_GROUP, false},
     {HighlightScrolledLines, "HighlightScrolledLines", SCROLLING_GROUP, true},
@@ -142,6 +142,17 @@ public:
          * FixedSizeHistory
          */
         HistorySize,
+        /** (bool) Whether the older lines of output are kept compressed
+         * in memory.  With UnlimitedHistory, this keeps the output in
+         * memory instead of in temporary files.
+         */
+        HistoryCompression,
+        /** (bool) Whether the history keeps an index of its lines while
+         * searching, so that the lines which can't match a search are
+         * skipped.  The index takes memory for every line of the history,
+         * and is freed when the search bar is closed.
+         */
+        HistorySearchIndex,
         /** (ScrollBarPositionEnum) Specifies the position of the scroll bar
          * in terminal displays using this profile.
          *
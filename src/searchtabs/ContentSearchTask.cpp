@@ -0,0 +1,282 @@
+/*
+    SPDX-FileCopyrightText: 2026 Konsole Plus contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+// Own
+#include "ContentSearchTask.h"
+
+// Qt
+#include <QThread>
+
+// STD
+#include <algorithm>
+
+// Konsole
+#include "Emulation.h"
+
+using namespace Konsole;
+
+namespace
+{
+// Number of lines decoded and searched at a time
+constexpr int BLOCK_LINES = 10000;
+// Number of lines of a history indexed per turn of the event loop
+constexpr int INDEX_LINES = 20000;
+}
+
+ContentSearchTask::ContentSearchTask(QObject *parent)
+    : SessionTask(parent)
+{
+    _searchPool.setMaxThreadCount(qMax(1, QThread::idealThreadCount()));
+}
+
+ContentSearchTask::~ContentSearchTask()
+{
+    // the workers refer to this task, so they have to finish first
+    _cancelled = true;
+    _searchPool.clear();
+    _searchPool.waitForDone();
+
+    for (SessionSearch &search : _searches) {
+        releaseSearchIndex(search);
+    }
+}
+
+void ContentSearchTask::setRegExp(const QRegularExpression &expression)
+{
+    _regExp = expression;
+}
+
+QRegularExpression ContentSearchTask::regExp() const
+{
+    return _regExp;
+}
+
+void ContentSearchTask::setMaxResultsPerSession(int count)
+{
+    _maxResultsPerSession = count;
+}
+
+bool ContentSearchTask::execute()
+{
+    if (_regExp.pattern().isEmpty()) {
+        Q_EMIT completed(false);
+        return false;
+    }
+
+    _prefilter = LiteralPrefilter(_regExp);
+    _regExp.optimize();
+
+    const QList<QPointer<Session>> &sessionList = sessions();
+    for (const QPointer<Session> &session : sessionList) {
+        if (session.isNull()) {
+            continue;
+        }
+
+        SessionSearch search;
+        search.session = session;
+        _searches.append(search);
+    }
+
+    queueBlocks();
+    return true;
+}
+
+void ContentSearchTask::cancel()
+{
+    if (_cancelled) {
+        return;
+    }
+
+    _cancelled = true;
+    _searchPool.clear();
+    for (SessionSearch &search : _searches) {
+        releaseSearchIndex(search);
+    }
+    _searches.clear();
+
+    if (autoDelete()) {
+        deleteLater();
+    }
+}
+
+void ContentSearchTask::scheduleQueueBlocks()
+{
+    if (_queueScheduled) {
+        return;
+    }
+
+    _queueScheduled = true;
+    QMetaObject::invokeMethod(
+        this,
+        [this]() {
+            _queueScheduled = false;
+            queueBlocks();
+        },
+        Qt::QueuedConnection);
+}
+
+void ContentSearchTask::queueBlocks()
+{
+    if (_cancelled) {
+        return;
+    }
+
+    // keep every worker busy with one block and one more waiting, but decode only one
+    // block per turn of the event loop so that input and painting are not held up
+    const int maxQueuedBlocks = 2 * _searchPool.maxThreadCount();
+    if (_queuedBlocks < maxQueuedBlocks) {
+        for (int i = 0; i < _searches.size(); ++i) {
+            const int index = (_nextSearch + i) % _searches.size();
+            if (queueBlock(_searches[index], index)) {
+                _nextSearch = (index + 1) % _searches.size();
+                if (_queuedBlocks < maxQueuedBlocks) {
+                    scheduleQueueBlocks();
+                }
+                return;
+            }
+        }
+    }
+
+    if (_queuedBlocks == 0) {
+        _cancelled = true;
+        bool found = false;
+        for (const SessionSearch &search : std::as_const(_searches)) {
+            found = found || search.resultCount > 0;
+        }
+        Q_EMIT completed(found);
+
+        if (autoDelete()) {
+            deleteLater();
+        }
+    }
+}
+
+void ContentSearchTask::releaseSearchIndex(SessionSearch &search)
+{
+    if (search.enabledSearchIndex && !search.session.isNull()) {
+        search.session->emulation()->setSearchIndexEnabled(false);
+    }
+    search.enabledSearchIndex = false;
+}
+
+bool ContentSearchTask::queueBlock(SessionSearch &search, int index)
+{
+    if (search.session.isNull()) {
+        search.finished = true;
+    }
+    if (search.finished) {
+        return false;
+    }
+
+    Emulation *emulation = search.session->emulation();
+    if (!search.started) {
+        if (_prefilter.canFilter()) {
+            if (!search.enabledSearchIndex && !emulation->isSearchIndexEnabled()) {
+                emulation->setSearchIndexEnabled(true);
+                search.enabledSearchIndex = emulation->isSearchIndexEnabled();
+            }
+
+            // building the index of a large history would hold up the GUI, so it
+            // is built over several turns
+            if (!emulation->buildSearchIndex(INDEX_LINES)) {
+                return true;
+            }
+        }
+
+        const int lineCount = emulation->lineCount();
+        const qint64 droppedLines = emulation->droppedLineCount();
+        const QVector<std::pair<int, int>> candidates = SearchHistoryTask::candidateLines(search.session, _prefilter, lineCount);
+        for (const auto &[first, last] : candidates) {
+            search.candidateLines.append({first + droppedLines, last + droppedLines});
+        }
+        search.endLine = droppedLines + lineCount;
+        search.nextLine = search.endLine;
+        search.started = true;
+        releaseSearchIndex(search);
+    }
+
+    // lines may have been dropped from the history since the search started
+    const qint64 droppedLines = emulation->droppedLineCount();
+    search.nextLine = qMin(search.nextLine, droppedLines + emulation->lineCount());
+
+    // collect up to BLOCK_LINES candidate lines, from the end of the output backwards
+    QVector<SearchHistoryTask::Segment> segments;
+    int lines = 0;
+    const auto candidatesBegin = search.candidateLines.cbegin();
+    while (lines < BLOCK_LINES && search.nextLine > droppedLines) {
+        auto candidates = std::upper_bound(candidatesBegin, search.candidateLines.cend(), search.nextLine - 1, [](qint64 line, const std::pair<qint64, qint64> &range) {
+            return line < range.first;
+        });
+        if (candidates == candidatesBegin) {
+            search.nextLine = droppedLines;
+            break;
+        }
+        --candidates;
+        const qint64 lastLine = qMin(search.nextLine - 1, candidates->second);
+        const qint64 firstLine = std::max({candidates->first, lastLine - (BLOCK_LINES - lines) + 1, droppedLines});
+        search.nextLine = firstLine;
+
+        segments.append(SearchHistoryTask::decodeLines(search.session, int(firstLine - droppedLines), int(lastLine - droppedLines)));
+        lines += int(lastLine - firstLine + 1);
+    }
+    if (search.nextLine <= droppedLines) {
+        search.finished = true;
+    }
+    if (segments.isEmpty()) {
+        return false;
+    }
+
+    ++_queuedBlocks;
+    const qint64 endLine = search.endLine;
+    _searchPool.start([this, regExp = _regExp, prefilter = _prefilter, segments, index, droppedLines, endLine]() {
+        QList<Result> results;
+        for (const SearchHistoryTask::Segment &segment : segments) {
+            const QList<int> matchLines = SearchHistoryTask::matchLines(segment, regExp, prefilter, _cancelled);
+            for (auto it = matchLines.crbegin(); it != matchLines.crend(); ++it) {
+                const int lineIndex = *it - segment.firstLine;
+                const qsizetype start = segment.linePositions.value(lineIndex, segment.text.size());
+                const qsizetype end = segment.linePositions.value(lineIndex + 1, segment.text.size());
+                const qint64 line = *it + droppedLines;
+                results.append(Result{line, int(endLine - 1 - line), segment.text.mid(start, end - start).trimmed()});
+            }
+        }
+
+        if (!_cancelled) {
+            QMetaObject::invokeMethod(
+                this,
+                [this, index, results]() {
+                    blockSearched(index, results);
+                },
+                Qt::QueuedConnection);
+        }
+    });
+
+    return true;
+}
+
+void ContentSearchTask::blockSearched(int index, const QList<Result> &results)
+{
+    --_queuedBlocks;
+    if (_cancelled) {
+        return;
+    }
+
+    SessionSearch &search = _searches[index];
+    if (!results.isEmpty() && !search.session.isNull() && search.resultCount < _maxResultsPerSession) {
+        const QList<Result> reported = results.mid(0, _maxResultsPerSession - search.resultCount);
+        search.resultCount += reported.size();
+        if (search.resultCount >= _maxResultsPerSession) {
+            search.finished = true;
+        }
+
+        Q_EMIT resultsFound(search.session, reported);
+        if (_cancelled) {
+            return;
+        }
+    }
+
+    queueBlocks();
+}
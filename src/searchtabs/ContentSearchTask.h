@@ -0,0 +1,128 @@
+/*
+    SPDX-FileCopyrightText: 2026 Konsole Plus contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+// Qt
+#include <QList>
+#include <QPointer>
+#include <QRegularExpression>
+#include <QThreadPool>
+#include <QVector>
+
+// STD
+#include <atomic>
+#include <utility>
+
+// Konsole
+#include "SearchHistoryTask.h"
+#include "filterHotSpots/LiteralPrefilter.h"
+#include "konsoleprivate_export.h"
+#include "session/Session.h"
+#include "session/SessionTask.h"
+
+namespace Konsole
+{
+/**
+ * A task which searches the screen and history of every session added with addSession()
+ * for lines matching a regular expression.
+ *
+ * Each session is searched backwards from the end of its output, so that the most recent
+ * matches are found first.  As in SearchHistoryTask, the output is decoded on the GUI thread,
+ * a block of lines at a time, and matched on worker threads.  The sessions take turns, and
+ * only a few blocks are decoded per turn of the event loop, so the GUI stays responsive
+ * however much output there is to search.  For the same reason, the search index of a
+ * history is built a part at a time, when the session takes its first turns.  Unless it
+ * was enabled already, the index is freed again once the lines to search are known.
+ *
+ * The matches are reported through resultsFound() as they are found.  completed() is emitted
+ * once every session has been searched.
+ */
+class KONSOLEPRIVATE_EXPORT ContentSearchTask : public SessionTask
+{
+    Q_OBJECT
+
+public:
+    /** A line containing a match */
+    struct Result {
+        /**
+         * Number of the line, counting the lines dropped from the top of the output
+         * before it, so that it stays valid while lines are dropped.  Subtract
+         * Emulation::droppedLineCount() to get the current line number.
+         */
+        qint64 line;
+        /** Number of lines of output which followed the line when the search started */
+        int age;
+        QString text;
+    };
+
+    explicit ContentSearchTask(QObject *parent = nullptr);
+    ~ContentSearchTask() override;
+
+    /** Sets the regular expression which is searched for when execute() is called */
+    void setRegExp(const QRegularExpression &expression);
+    /** Returns the regular expression which is searched for when execute() is called */
+    QRegularExpression regExp() const;
+
+    /** Sets the maximum number of matching lines reported for each session */
+    void setMaxResultsPerSession(int count);
+
+    /** Starts searching the sessions */
+    bool execute() override;
+
+    /**
+     * Stops the search in progress.  No further signals are emitted, and the
+     * task deletes itself if autoDelete() is set.
+     */
+    void cancel();
+
+Q_SIGNALS:
+    /** Emitted with matching lines of @p session, most recent first */
+    void resultsFound(Session *session, const QList<ContentSearchTask::Result> &results);
+
+private:
+    // progress of the search in one session, with line numbers counting the
+    // dropped lines as in Result::line
+    struct SessionSearch {
+        QPointer<Session> session;
+        // the lines which may contain a match, as pairs of first and last line numbers
+        QVector<std::pair<qint64, qint64>> candidateLines;
+        // the end of the output when the search of the session started
+        qint64 endLine = 0;
+        // lines before this one are left to be searched
+        qint64 nextLine = 0;
+        int resultCount = 0;
+        // the search index is built and the candidate lines are known
+        bool started = false;
+        // the search index was enabled for this task, and is disabled again
+        // once the candidate lines are known
+        bool enabledSearchIndex = false;
+        bool finished = false;
+    };
+
+    void scheduleQueueBlocks();
+    void queueBlocks();
+    // returns true if work was done for the search in this turn of the event loop
+    bool queueBlock(SessionSearch &search, int index);
+    void blockSearched(int index, const QList<Result> &results);
+    void releaseSearchIndex(SessionSearch &search);
+
+    QRegularExpression _regExp;
+    LiteralPrefilter _prefilter;
+    int _maxResultsPerSession = 20;
+
+    QVector<SessionSearch> _searches;
+    // the session which takes the next turn
+    int _nextSearch = 0;
+    int _queuedBlocks = 0;
+    bool _queueScheduled = false;
+
+    std::atomic<bool> _cancelled{false};
+    // must be the last member
+    QThreadPool _searchPool;
+};
+
+}
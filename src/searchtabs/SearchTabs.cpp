@@ -9,6 +9,7 @@
 
 // Qt
 #include <QApplication>
+#include <QHash>
 #include <QKeyEvent>
 #include <QModelIndex>
 #include <QSortFilterProxyModel>
@@ -19,7 +20,11 @@
 #include <KLocalizedString>
 
 // Konsole
+#include "Emulation.h"
 #include "KonsoleSettings.h"
+#include "SearchHistoryTask.h"
+#include "session/SessionController.h"
+#include "terminalDisplay/TerminalDisplay.h"
 
 using namespace Konsole;
 
@@ -129,6 +134,18 @@ SearchTabs::SearchTabs(ViewManager *viewManager)
     m_inputLine->setCursor(Qt::IBeamCursor);
     m_inputLine->setFont(QApplication::font());
     m_inputLine->setFrame(false);
+
+    // search the output of the tabs instead of their names
+    m_contentSearchAction = m_inputLine->addAction(QIcon::fromTheme(QStringLiteral("edit-find-replace")), QLineEdit::TrailingPosition);
+    m_contentSearchAction->setCheckable(true);
+    m_contentSearchAction->setToolTip(i18nc("@info:tooltip", "Search Tab Contents"));
+    connect(m_contentSearchAction, &QAction::toggled, this, &SearchTabs::setContentSearch);
+
+    // wait for a pause in typing before searching the output of every tab
+    m_contentSearchTimer = new QTimer(this);
+    m_contentSearchTimer->setSingleShot(true);
+    m_contentSearchTimer->setInterval(300);
+    connect(m_contentSearchTimer, &QTimer::timeout, this, &SearchTabs::startContentSearch);
     // When the widget focus is set, focus input box instead
     setFocusProxy(m_inputLine);
 
@@ -157,6 +174,11 @@ SearchTabs::SearchTabs(ViewManager *viewManager)
 
     // use fuzzy sort to identify tabs with matching titles
     connect(m_inputLine, &QLineEdit::textChanged, this, [this](const QString &text) {
+        if (m_contentSearchAction->isChecked()) {
+            m_contentSearchTimer->start();
+            return;
+        }
+
         // initialize the proxy model when there is something to filter
         bool didFilter = false;
         if (!m_proxyModel) {
@@ -250,12 +272,90 @@ void SearchTabs::updateState()
     setFocus();
 }
 
+void SearchTabs::setContentSearch(bool enabled)
+{
+    if (enabled) {
+        m_inputLine->setToolTip(i18nc("@info:tooltip", "Enter text to search for in the output of all tabs here"));
+        m_listView->setModel(m_model);
+        startContentSearch();
+        return;
+    }
+
+    m_contentSearchTimer->stop();
+    if (m_contentSearchTask) {
+        m_contentSearchTask->cancel();
+    }
+
+    m_inputLine->setToolTip(i18nc("@info:tooltip", "Enter a tab name to search for here"));
+    m_model->refresh(m_viewManager);
+    if (m_proxyModel) {
+        m_proxyModel->setFilterText(m_inputLine->text());
+        m_listView->setModel(m_proxyModel);
+    }
+    reselectFirst();
+}
+
+void SearchTabs::startContentSearch()
+{
+    m_contentSearchTimer->stop();
+    if (m_contentSearchTask) {
+        m_contentSearchTask->cancel();
+    }
+    m_model->clear();
+
+    const QString text = m_inputLine->text();
+    if (text.isEmpty()) {
+        return;
+    }
+
+    m_contentSearchTask = new ContentSearchTask(this);
+    m_contentSearchTask->setAutoDelete(true);
+    m_contentSearchTask->setRegExp(QRegularExpression(QRegularExpression::escape(text), QRegularExpression::CaseInsensitiveOption));
+
+    QHash<Session *, QPointer<ViewProperties>> views;
+    const QList<ViewProperties *> viewProperties = m_viewManager->viewProperties();
+    for (ViewProperties *view : viewProperties) {
+        auto *controller = qobject_cast<SessionController *>(view);
+        if (controller && controller->isValid()) {
+            views.insert(controller->session(), view);
+            m_contentSearchTask->addSession(controller->session());
+        }
+    }
+
+    connect(m_contentSearchTask, &ContentSearchTask::resultsFound, this, [this, views](Session *session, const QList<ContentSearchTask::Result> &results) {
+        const QPointer<ViewProperties> view = views.value(session);
+        if (view.isNull()) {
+            return;
+        }
+
+        const bool hadResults = m_model->rowCount() > 0;
+        m_model->addResults(view, results);
+        if (!hadResults) {
+            reselectFirst();
+        }
+    });
+
+    m_contentSearchTask->execute();
+}
+
 void SearchTabs::slotReturnPressed()
 {
     // switch to tab using the unique ViewProperties identifier
     // (the view identifier is off by 1)
     const QModelIndex index = m_listView->currentIndex();
-    m_viewManager->setCurrentView(index.data(SearchTabsModel::View).toInt() - 1);
+    const int id = index.data(SearchTabsModel::View).toInt();
+    m_viewManager->setCurrentView(id - 1);
+
+    // show the matching line of a content search result
+    const qint64 line = index.data(SearchTabsModel::Line).toLongLong();
+    auto *controller = qobject_cast<SessionController *>(ViewProperties::propertiesById(id));
+    if (index.isValid() && line >= 0 && controller && controller->isValid() && controller->view()->screenWindow()) {
+        // lines may have been dropped from the top of the history since the search
+        const qint64 currentLine = line - controller->session()->emulation()->droppedLineCount();
+        if (currentLine >= 0) {
+            SearchHistoryTask::highlightResult(controller->view()->screenWindow(), int(currentLine));
+        }
+    }
 
     hide();
     deleteLater();
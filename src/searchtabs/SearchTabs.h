@@ -13,6 +13,8 @@
 #include <QEvent>
 #include <QFrame>
 #include <QLineEdit>
+#include <QPointer>
+#include <QTimer>
 #include <QTreeView>
 
 // Konsole
@@ -48,6 +50,12 @@ private:
      */
     void slotReturnPressed();
 
+    /** Switches between searching the tab names and the contents of the tabs */
+    void setContentSearch(bool enabled);
+
+    /** Starts searching the contents of the tabs for the text of the input line */
+    void startContentSearch();
+
 private:
     ViewManager *m_viewManager;
 
@@ -63,6 +71,13 @@ private:
      * fuzzy filter model
      */
     SearchTabsFilterProxyModel *m_proxyModel = nullptr;
+
+    /**
+     * content search
+     */
+    QAction *m_contentSearchAction = nullptr;
+    QTimer *m_contentSearchTimer = nullptr;
+    QPointer<ContentSearchTask> m_contentSearchTask;
 };
 
 }
@@ -7,6 +7,12 @@
 // Own
 #include "SearchTabsModel.h"
 
+// STD
+#include <algorithm>
+
+// KDE
+#include <KLocalizedString>
+
 // Konsole
 #include "ViewProperties.h"
 
@@ -46,6 +52,8 @@ QVariant SearchTabsModel::data(const QModelIndex &idx, int role) const
         return tab.score;
     case Role::View:
         return tab.view;
+    case Role::Line:
+        return tab.line;
     default:
         return {};
     }
@@ -67,3 +75,24 @@ void SearchTabsModel::refresh(ViewManager *viewManager)
     m_tabEntries = std::move(tabs);
     endResetModel();
 }
+
+void SearchTabsModel::clear()
+{
+    beginResetModel();
+    m_tabEntries.clear();
+    endResetModel();
+}
+
+void SearchTabsModel::addResults(ViewProperties *view, const QList<ContentSearchTask::Result> &results)
+{
+    for (const ContentSearchTask::Result &result : results) {
+        const auto position = std::upper_bound(m_tabEntries.cbegin(), m_tabEntries.cend(), result.age, [](int age, const TabEntry &entry) {
+            return age < entry.age;
+        });
+        const int row = static_cast<int>(std::distance(m_tabEntries.cbegin(), position));
+
+        beginInsertRows(QModelIndex(), row, row);
+        m_tabEntries.insert(row, TabEntry{i18nc("@item tab title and matching line", "%1: %2", view->title(), result.text), view->identifier(), -1, result.line, result.age});
+        endInsertRows();
+    }
+}
@@ -12,6 +12,7 @@
 #include <QVector>
 
 // Konsole
+#include "ContentSearchTask.h"
 #include "ViewManager.h"
 
 namespace Konsole
@@ -21,6 +22,10 @@ struct TabEntry {
     QString name;
     int view;
     int score = -1;
+    // the matching line of a content search result, or -1 for a tab.
+    // See ContentSearchTask::Result::line
+    qint64 line = -1;
+    int age = -1;
 };
 
 class SearchTabsModel : public QAbstractTableModel
@@ -30,6 +35,7 @@ public:
         Name = Qt::UserRole + 1,
         View,
         Score,
+        Line,
     };
     explicit SearchTabsModel(QObject *parent = nullptr);
 
@@ -38,6 +44,15 @@ public:
     QVariant data(const QModelIndex &idx, int role) const override;
     void refresh(ViewManager *viewManager);
 
+    /** Removes all entries */
+    void clear();
+
+    /**
+     * Adds the matching lines found by a content search in the tab @p view,
+     * keeping the entries sorted with the most recent lines first
+     */
+    void addResults(ViewProperties *view, const QList<ContentSearchTask::Result> &results);
+
     bool isValid(int row) const
     {
         return row >= 0 && row < m_tabEntries.size();
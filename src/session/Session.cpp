@@ -170,6 +170,9 @@ void Session::openTeletype(int fd, bool runShell)
         return;
     }
 
+    if (_shellProcess != nullptr) {
+        flushPendingOutput();
+    }
     delete _shellProcess;
 
     if (fd < 0) {
@@ -1129,6 +1132,9 @@ void Session::done(int exitCode, QProcess::ExitStatus exitStatus)
     disconnect(_shellProcess, &Konsole::Pty::finished, this, &Konsole::Session::done);
 #endif
 
+    // show everything the program printed before the messages below
+    flushPendingOutput();
+
     if (!_autoClose) {
         _userTitle = i18nc("@info:shell This session is done", "Finished");
         Q_EMIT sessionAttributeChanged();
@@ -1686,6 +1692,9 @@ void Session::cancelZModem()
 
 void Session::startZModem(const QString &zmodem, const QString &dir, const QStringList &list)
 {
+    // output read before the transfer started still belongs to the terminal
+    flushPendingOutput();
+
     _zmodemBusy = true;
     _zmodemProc = new KProcess();
     _zmodemProc->setOutputChannelMode(KProcess::SeparateChannels);
@@ -1785,7 +1794,73 @@ void Session::zmodemFinished()
 void Session::onReceiveBlock(const char *buf, int len)
 {
     handleActivity();
-    _emulation->receiveData(buf, len);
+
+    if (!KonsoleSettings::limitOutputProcessingTime()) {
+        _emulation->receiveData(buf, len);
+        return;
+    }
+
+    _pendingOutput.append(buf, len);
+    processPendingOutput();
+}
+
+void Session::processPendingOutput()
+{
+    // Maximum time spent on output per event loop iteration; sessions that are
+    // not visible get less, so the one the user is looking at stays fluent.
+    static const int VISIBLE_SLICE_MSEC = 10;
+    static const int HIDDEN_SLICE_MSEC = 2;
+    // Output is handed to the emulation in blocks of this size, so a huge read
+    // cannot overshoot the time slice by much
+    static const int OUTPUT_CHUNK_SIZE = 16 * 1024;
+
+    if (!_outputSlice.isValid()) {
+        _outputSlice.start();
+        // the slice ends once the event loop had a chance to handle input and painting
+        QTimer::singleShot(0, this, &Konsole::Session::endOutputSlice);
+    }
+
+    const bool visible = std::any_of(_views.constBegin(), _views.constEnd(), [](const TerminalDisplay *display) {
+        return display->isVisible();
+    });
+    const int sliceMsec = visible ? VISIBLE_SLICE_MSEC : HIDDEN_SLICE_MSEC;
+
+    int offset = 0;
+    while (offset < _pendingOutput.size() && _outputSlice.elapsed() < sliceMsec) {
+        const int length = qMin(OUTPUT_CHUNK_SIZE, int(_pendingOutput.size()) - offset);
+        _emulation->receiveData(_pendingOutput.constData() + offset, length);
+        offset += length;
+    }
+    _pendingOutput.remove(0, offset);
+
+    // stop reading until the backlog is processed, the program writing
+    // the output blocks on the full pty buffer in the meantime
+    if (!_pendingOutput.isEmpty()) {
+        _shellProcess->setReadSuspended(true);
+    }
+}
+
+void Session::endOutputSlice()
+{
+    _outputSlice.invalidate();
+
+    if (!_pendingOutput.isEmpty()) {
+        processPendingOutput();
+    }
+    if (_pendingOutput.isEmpty()) {
+        _shellProcess->setReadSuspended(false);
+    }
+}
+
+void Session::flushPendingOutput()
+{
+    if (_pendingOutput.isEmpty()) {
+        return;
+    }
+
+    _emulation->receiveData(_pendingOutput.constData(), _pendingOutput.size());
+    _pendingOutput.clear();
+    _shellProcess->setReadSuspended(false);
 }
 
 QSize Session::size()
@@ -1948,12 +2023,18 @@ void Session::setHistorySize(int lines)
         return;
     }
 
+    // keep the history compressed if it already is
+    const bool compressed = historyType().isCompressed();
     if (lines < 0) {
-        setHistoryType(HistoryTypeFile());
+        if (compressed) {
+            setHistoryType(CompactHistoryType(CompactHistoryType::Unlimited, true));
+        } else {
+            setHistoryType(HistoryTypeFile());
+        }
     } else if (lines == 0) {
         setHistoryType(HistoryTypeNone());
     } else {
-        setHistoryType(CompactHistoryType(lines));
+        setHistoryType(CompactHistoryType(lines, compressed));
     }
 }
 
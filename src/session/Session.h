@@ -12,6 +12,7 @@
 #include "config-konsole.h"
 
 // Qt
+#include <QElapsedTimer>
 #include <QHash>
 #include <QLoggingCategory>
 #include <QProcess>
@@ -924,6 +925,7 @@ private Q_SLOTS:
     void fireZModemUploadDetected();
 
     void onReceiveBlock(const char *buf, int len);
+    void endOutputSlice();
     void silenceTimerDone();
     void activityTimerDone();
     void resetNotifications();
@@ -970,6 +972,11 @@ private:
     void updateContainerContext();
     SessionController *controller();
 
+    // feeds _pendingOutput to the emulation until the current time slice is used up
+    void processPendingOutput();
+    // hands all of _pendingOutput to the emulation, regardless of the time slice
+    void flushPendingOutput();
+
     QString validDirectory(const QString &dir) const;
 
     QUuid _uniqueIdentifier; // SHELL_SESSION_ID
@@ -977,6 +984,10 @@ private:
     Pty *_shellProcess = nullptr;
     Emulation *_emulation = nullptr;
 
+    // output read from the pty but not yet processed, see processPendingOutput()
+    QByteArray _pendingOutput;
+    QElapsedTimer _outputSlice;
+
     QList<TerminalDisplay *> _views;
 
     // monitor activity & silence
@@ -91,6 +91,9 @@
 #include "terminalDisplay/TerminalDisplay.h"
 #include "terminalDisplay/TerminalScrollBar.h"
 
+// STD
+#include <algorithm>
+
 // For Unix signal names
 #include <csignal>
 
@@ -1570,6 +1573,13 @@ void SessionController::listenForScreenWindowUpdates()
     connect(view()->screenWindow(), &Konsole::ScreenWindow::scrolled, this, &Konsole::SessionController::updateSearchFilter);
     connect(view()->screenWindow(), &Konsole::ScreenWindow::currentResultLineChanged, view(), QOverload<>::of(&Konsole::TerminalDisplay::update));
 
+    // new output may move the lines which matched the last search
+    connect(session()->emulation(), &Konsole::Emulation::outputChanged, this, [this]() {
+        _searchMatches.lines.clear();
+        _searchMatches.complete = false;
+        _searchMatches.outdated = true;
+    });
+
     _listenForScreenWindowUpdates = true;
 }
 
@@ -1674,11 +1684,15 @@ void SessionController::searchHistory(bool showSearchBar)
             view()->filterChain()->addFilter(_searchFilter);
             view()->processFilters();
 
+            // the search index is only kept while searching, if the profile allows it
+            session()->emulation()->setSearchIndexEnabled(true);
+
             setFindNextPrevEnabled(true);
         } else {
             setFindNextPrevEnabled(false);
 
             removeSearchFilter();
+            session()->emulation()->setSearchIndexEnabled(false);
 
             view()->setFocus(Qt::ActiveWindowFocusReason);
         }
@@ -1724,6 +1738,11 @@ void SessionController::beginSearch(const QString &text, Enum::SearchDirection d
     Q_ASSERT(_searchBar);
     Q_ASSERT(_searchFilter);
 
+    // a search still running for the previous text is of no use anymore
+    if (!_searchTask.isNull()) {
+        _searchTask->cancel();
+    }
+
     QRegularExpression regExp = regexpFromSearchBarOptions();
     _searchFilter->setRegExp(regExp);
 
@@ -1740,7 +1759,8 @@ void SessionController::beginSearch(const QString &text, Enum::SearchDirection d
         auto task = new SearchHistoryTask(this);
 
         connect(task, &Konsole::SearchHistoryTask::completed, this, &Konsole::SessionController::searchCompleted);
-        connect(task, &Konsole::SearchHistoryTask::searchResults, view()->scrollBar(), &Konsole::TerminalScrollBar::searchLines);
+        connect(task, &Konsole::SearchHistoryTask::searchResults, view()->scrollBar(), &Konsole::TerminalScrollBar::addSearchLines);
+        view()->scrollBar()->clearSearchLines();
 
         task->setRegExp(regExp);
         task->setSearchDirection(direction);
@@ -1748,6 +1768,32 @@ void SessionController::beginSearch(const QString &text, Enum::SearchDirection d
         task->setAutoDelete(true);
         task->setStartLine(_searchStartLine);
         task->addScreenWindow(session(), view()->screenWindow());
+
+        // refining the last search only has to look at the lines which matched it
+        QVector<std::pair<int, int>> lines;
+        if (narrowSearch(text, &lines)) {
+            task->setCandidateLines(lines);
+        }
+
+        const QBitArray options = _searchBar->optionsChecked();
+        _searchMatches = SearchMatches{};
+        if (!options.at(IncrementalSearchBar::RegExp)) {
+            _searchMatches.text = text;
+            _searchMatches.caseSensitive = options.at(IncrementalSearchBar::MatchCase);
+            _searchMatches.columns = view()->screenWindow()->columnCount();
+            connect(task, &Konsole::SearchHistoryTask::searchResults, this, [this](const QList<int> &lines) {
+                _searchMatches.lines.append(lines);
+            });
+            connect(task, &Konsole::SearchHistoryTask::finished, this, [this]() {
+                if (!_searchMatches.outdated) {
+                    std::sort(_searchMatches.lines.begin(), _searchMatches.lines.end());
+                    _searchMatches.lines.erase(std::unique(_searchMatches.lines.begin(), _searchMatches.lines.end()), _searchMatches.lines.end());
+                    _searchMatches.complete = true;
+                }
+            });
+        }
+
+        _searchTask = task;
         task->execute();
     } else if (text.isEmpty()) {
         view()->scrollBar()->clearSearchLines();
@@ -1756,6 +1802,25 @@ void SessionController::beginSearch(const QString &text, Enum::SearchDirection d
 
     view()->processFilters();
 }
+bool SessionController::narrowSearch(const QString &text, QVector<std::pair<int, int>> *lines) const
+{
+    const QBitArray options = _searchBar->optionsChecked();
+    const bool caseSensitive = options.at(IncrementalSearchBar::MatchCase);
+    const int columns = view()->screenWindow()->columnCount();
+    if (!_searchMatches.complete || options.at(IncrementalSearchBar::RegExp) || _searchMatches.caseSensitive != caseSensitive
+        || _searchMatches.columns != columns || columns <= 0) {
+        return false;
+    }
+
+    const int offset = text.lastIndexOf(_searchMatches.text, -1, caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive);
+    if (offset < 0) {
+        return false;
+    }
+
+    *lines = SearchHistoryTask::linesAround(_searchMatches.lines, offset, text.size(), columns);
+    return true;
+}
+
 void SessionController::highlightMatches(bool highlight)
 {
     if (highlight) {
@@ -1835,9 +1900,10 @@ void SessionController::showHistoryOptions()
     } else {
         dialog->setMode(Enum::NoHistory);
     }
+    dialog->setCompressed(currentHistory.isCompressed());
 
     connect(dialog, &QDialog::accepted, this, [this, dialog]() {
-        scrollBackOptionsChanged(dialog->mode(), dialog->lineCount());
+        scrollBackOptionsChanged(dialog->mode(), dialog->lineCount(), dialog->isCompressed());
     });
 
     dialog->show();
@@ -1847,17 +1913,21 @@ void SessionController::sessionResizeRequest(const QSize &size)
     ////qDebug() << "View resize requested to " << size;
     view()->setSize(size.width(), size.height());
 }
-void SessionController::scrollBackOptionsChanged(int mode, int lines)
+void SessionController::scrollBackOptionsChanged(int mode, int lines, bool compressed)
 {
     switch (mode) {
     case Enum::NoHistory:
         session()->setHistoryType(HistoryTypeNone());
         break;
     case Enum::FixedSizeHistory:
-        session()->setHistoryType(CompactHistoryType(lines));
+        session()->setHistoryType(CompactHistoryType(lines, compressed));
         break;
     case Enum::UnlimitedHistory:
-        session()->setHistoryType(HistoryTypeFile());
+        if (compressed) {
+            session()->setHistoryType(CompactHistoryType(CompactHistoryType::Unlimited, true));
+        } else {
+            session()->setHistoryType(HistoryTypeFile());
+        }
         break;
     }
 }
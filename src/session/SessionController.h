@@ -18,6 +18,7 @@
 #include <KXMLGUIClient>
 
 #include <memory>
+#include <utility>
 
 // Konsole
 #include "Enumeration.h"
@@ -54,6 +55,7 @@ class UrlFilter;
 class ColorFilter;
 class HotSpot;
 class SaveHistoryAutoTask;
+class SearchHistoryTask;
 
 /**
  * Provides the menu actions to manipulate a single terminal session and view pair.
@@ -331,7 +333,7 @@ private Q_SLOTS:
     // foreground process in the terminal
 
     void highlightMatches(bool highlight);
-    void scrollBackOptionsChanged(int mode, int lines);
+    void scrollBackOptionsChanged(int mode, int lines, bool compressed);
     void sessionResizeRequest(const QSize &size);
     void trackOutput(QKeyEvent *event); // move view to end of current output
     // when a key press occurs in the
@@ -354,6 +356,9 @@ private:
     // direction - value from SearchHistoryTask::SearchDirection enum to specify
     //             the search direction
     void beginSearch(const QString &text, Enum::SearchDirection direction, bool noWrap);
+    // stores the lines which need to be searched for text in lines, if the lines matching
+    // an earlier search are known and every match of text also matches that search
+    bool narrowSearch(const QString &text, QVector<std::pair<int, int>> *lines) const;
     QRegularExpression regexpFromSearchBarOptions() const;
     bool reverseSearchChecked() const;
     bool noWrapChecked() const;
@@ -417,6 +422,21 @@ private:
 
     QString _searchText = QString();
     QPointer<IncrementalSearchBar> _searchBar;
+    QPointer<SearchHistoryTask> _searchTask;
+
+    // The lines matching the last search for plain text, which a search for text
+    // containing it only has to look at again
+    struct SearchMatches {
+        QString text;
+        bool caseSensitive = false;
+        int columns = 0;
+        QList<int> lines;
+        // every line of the output has been searched
+        bool complete = false;
+        // there was new output while searching
+        bool outdated = false;
+    };
+    SearchMatches _searchMatches;
 
     QString _previousForegroundProcessName = QString();
     bool _monitorProcessFinish;
@@ -242,8 +242,9 @@ void SessionManager::applyProfile(Session *session, const Profile::Ptr &profile,
     }
 
     // History
-    if (apply.shouldApply(Profile::HistoryMode) || apply.shouldApply(Profile::HistorySize)) {
+    if (apply.shouldApply(Profile::HistoryMode) || apply.shouldApply(Profile::HistorySize) || apply.shouldApply(Profile::HistoryCompression)) {
         const auto mode = profile->property<int>(Profile::HistoryMode);
+        const bool compressed = profile->property<bool>(Profile::HistoryCompression);
         switch (mode) {
         case Enum::NoHistory:
             session->setHistoryType(HistoryTypeNone());
@@ -251,16 +252,25 @@ void SessionManager::applyProfile(Session *session, const Profile::Ptr &profile,
 
         case Enum::FixedSizeHistory: {
             int lines = profile->historySize();
-            session->setHistoryType(CompactHistoryType(lines));
+            session->setHistoryType(CompactHistoryType(lines, compressed));
             break;
         }
 
         case Enum::UnlimitedHistory:
-            session->setHistoryType(HistoryTypeFile());
+            // compressed history is small enough to stay in memory
+            if (compressed) {
+                session->setHistoryType(CompactHistoryType(CompactHistoryType::Unlimited, true));
+            } else {
+                session->setHistoryType(HistoryTypeFile());
+            }
             break;
         }
     }
 
+    if (apply.shouldApply(Profile::HistorySearchIndex)) {
+        session->emulation()->setSearchIndexAllowed(profile->property<bool>(Profile::HistorySearchIndex));
+    }
+
     // Terminal features
     if (apply.shouldApply(Profile::FlowControlEnabled)) {
         session->setFlowControlEnabled(profile->flowControlEnabled());
@@ -79,6 +79,9 @@
 #include "unicode/ushape.h"
 #include "unicode/utypes.h"
 
+// STD
+#include <algorithm>
+
 #define MAX_LINE_WIDTH 1024
 
 using namespace Konsole;
@@ -122,6 +125,7 @@ void TerminalDisplay::setScreenWindow(ScreenWindow *window)
     }
 
     _screenWindow = window;
+    _compareAllLines = true;
 
     if (!_screenWindow.isNull()) {
         connect(_screenWindow.data(), &Konsole::ScreenWindow::outputChanged, this, &Konsole::TerminalDisplay::updateImage);
@@ -172,6 +176,32 @@ static UCharDirection BiDiClass([[maybe_unused]] const void *context, UChar32 c)
     return U_CHAR_DIRECTION_COUNT;
 };
 
+// Returns false for characters which may be right-to-left, need Arabic
+// shaping or change the direction of the text around them
+static bool isLeftToRightOnly(char32_t c)
+{
+    if (c < 0x0590) {
+        return true;
+    }
+    // Hebrew, Arabic, Syriac, Thaana, NKo, Samaritan, Mandaic
+    if (c <= 0x08ff) {
+        return false;
+    }
+    // directional marks, embeddings, overrides and isolates
+    if ((c >= 0x200e && c <= 0x200f) || (c >= 0x202a && c <= 0x202e) || (c >= 0x2066 && c <= 0x2069)) {
+        return false;
+    }
+    // Hebrew and Arabic presentation forms
+    if (c >= 0xfb1d && c <= 0xfeff) {
+        return false;
+    }
+    // right-to-left scripts of the supplementary planes
+    if ((c >= 0x10800 && c <= 0x10fff) || (c >= 0x1e800 && c <= 0x1efff)) {
+        return false;
+    }
+    return true;
+}
+
 /* ------------------------------------------------------------------------- */
 /*                                                                           */
 /*                         Accessibility                                     */
@@ -330,6 +360,7 @@ TerminalDisplay::TerminalDisplay(QWidget *parent)
 
     _printManager.reset(new KonsolePrintManager(ldrawBackground, ldrawContents, lgetBackgroundColor));
     ubidi = ubidi_open();
+    _bidiCache.setMaxCost(512);
 
     animationTimer = new QTimer(this);
     connect(animationTimer, &QTimer::timeout, this, [this]() {
@@ -511,6 +542,15 @@ void TerminalDisplay::updateImage()
     const int columns = _screenWindow->windowColumns();
     QVector<LineProperty> newLineProperties = _screenWindow->getLineProperties();
 
+    // the lines which didn't change on the screen still match _image, unless it
+    // has been replaced or the image of the window has a different size
+    const QVector<bool> changedLines = _screenWindow->takeChangedLines();
+    const bool compareAllLines = _compareAllLines || changedLines.size() != lines || _blinkingLines.size() != lines;
+    _compareAllLines = false;
+    if (_blinkingLines.size() != lines) {
+        _blinkingLines.fill(false, lines);
+    }
+
     _scrollBar->setScroll(_screenWindow->currentLine(), _screenWindow->lineCount());
 
     Q_ASSERT(_usedLines <= _lines);
@@ -523,7 +563,6 @@ void TerminalDisplay::updateImage()
     const QPoint tL = contentsRect().topLeft();
     const int tLx = tL.x();
     const int tLy = tL.y();
-    _hasTextBlinker = false;
 
     CharacterColor cf; // undefined
 
@@ -537,10 +576,15 @@ void TerminalDisplay::updateImage()
     std::optional<int> endDirtyIndex;
 
     for (y = 0; y < linesToUpdate; ++y) {
+        if (!compareAllLines && !changedLines.at(y)) {
+            continue;
+        }
+
         const Character *currentLine = &_image[y * _columns];
         const Character *const newLine = &newimg[y * columns];
 
         bool updateLine = false;
+        _blinkingLines[y] = false;
 
         // The dirty mask indicates which characters need repainting. We also
         // mark surrounding neighbors dirty, in case the character exceeds
@@ -561,7 +605,7 @@ void TerminalDisplay::updateImage()
 
         if (!_resizing) { // not while _resizing, we're expecting a paintEvent
             for (x = 0; x < columnsToUpdate; ++x) {
-                _hasTextBlinker |= newLine[x].rendition.f.blink;
+                _blinkingLines[y] = _blinkingLines[y] || newLine[x].rendition.f.blink;
 
                 // Start drawing if this character or the next one differs.
                 // We also take the next one into account to handle the situation
@@ -620,6 +664,7 @@ void TerminalDisplay::updateImage()
         memcpy((void *)currentLine, (const void *)newLine, columnsToUpdate * sizeof(Character));
     }
     _lineProperties = newLineProperties;
+    _hasTextBlinker = _blinkingLines.mid(0, linesToUpdate).contains(true);
 
     // if the new _image is smaller than the previous _image, then ensure that the area
     // outside the new _image is cleared
@@ -1083,6 +1128,7 @@ void TerminalDisplay::makeImage()
 void TerminalDisplay::clearImage()
 {
     std::fill(_image, _image + _imageSize, Screen::DefaultChar);
+    _compareAllLines = true;
 }
 
 void TerminalDisplay::calcGeometry()
@@ -3210,6 +3256,7 @@ void TerminalDisplay::applyProfile(const Profile::Ptr &profile)
     _bidiEnabled = profile->bidiRenderingEnabled();
     _bidiLineLTR = profile->bidiLineLTR();
     _bidiTableDirOverride = profile->bidiTableDirOverride();
+    _bidiCache.clear();
     _semanticUpDown = profile->semanticUpDown();
     _semanticInputClick = profile->semanticInputClick();
     _trimLeadingSpaces = profile->property<bool>(Profile::TrimLeadingSpacesInSelectedText);
@@ -3307,6 +3354,7 @@ int TerminalDisplay::bidiMap(Character *screenline,
     uint32_t notSkipped[MAX_LINE_WIDTH / 32] = {};
     int i;
     int lastNonSpace = 0;
+    bool leftToRightOnly = true;
     shaped = false;
 
     // use one string to assign into to avoid temporary allocations
@@ -3325,11 +3373,13 @@ int TerminalDisplay::bidiMap(Character *screenline,
                 Q_ASSERT(extendedCharLength > 1);
                 convertBuffer.assign(chars, chars + extendedCharLength);
                 line.append(convertBuffer);
+                leftToRightOnly = leftToRightOnly && std::all_of(chars, chars + extendedCharLength, isLeftToRightOnly);
             }
             lastNonSpace = i;
         } else {
             convertBuffer.assign(&char_value.character, &char_value.character + 1);
             line.append(convertBuffer);
+            leftToRightOnly = leftToRightOnly && isLeftToRightOnly(char_value.character);
             if (!line[line.size() - 1].isSpace()) {
                 lastNonSpace = i;
             }
@@ -3337,6 +3387,31 @@ int TerminalDisplay::bidiMap(Character *screenline,
     }
     log2line[i] = line.size();
     // line.truncate(lastNonSpace + 1);
+    const int result = bidi && !_bidiLineLTR ? linewidth - 1 : lastNonSpace;
+
+    // nothing to shape, and the visual order is the logical order
+    if (leftToRightOnly) {
+        if (bidi) {
+            std::copy(log2line, log2line + linewidth, vis2line);
+        }
+        return result;
+    }
+
+    const std::pair<QString, int> key(line, (shape ? 1 : 0) | (bidi ? 2 : 0));
+    if (const BidiLine *cached = _bidiCache.object(key)) {
+        // the same text may be split into cells differently
+        if (std::equal(log2line, log2line + linewidth + 1, cached->log2line.constBegin(), cached->log2line.constEnd())) {
+            line = cached->line;
+            shaped = cached->shaped;
+            std::copy(cached->shapemap.constBegin(), cached->shapemap.constEnd(), shapemap);
+            std::copy(cached->vis2line.constBegin(), cached->vis2line.constEnd(), vis2line);
+            return result;
+        }
+    }
+
+    auto *bidiLine = new BidiLine;
+    bidiLine->log2line = QVector<int>(log2line, log2line + linewidth + 1);
+
     UErrorCode errorCode = U_ZERO_ERROR;
     if (shape) {
         int added_a = -1;
@@ -3419,9 +3494,13 @@ int TerminalDisplay::bidiMap(Character *screenline,
             shapemap[added_a] = ' ';
             line[added_a] = u' ';
         }
+        bidiLine->shapemap = QVector<uint16_t>(shapemap, shapemap + line.length());
+        bidiLine->shaped = shaped;
     }
+    bidiLine->line = line;
     if (!bidi) {
-        return lastNonSpace;
+        _bidiCache.insert(key, bidiLine);
+        return result;
     }
     UBiDiLevel paraLevel = _bidiLineLTR ? 0 : UBIDI_DEFAULT_LTR;
     if (_bidiTableDirOverride) {
@@ -3437,7 +3516,9 @@ int TerminalDisplay::bidiMap(Character *screenline,
             vis2line[p++] = semi_vis2line[i];
         }
     }
-    return _bidiLineLTR ? lastNonSpace : linewidth - 1;
+    bidiLine->vis2line = QVector<int32_t>(vis2line, vis2line + p);
+    _bidiCache.insert(key, bidiLine);
+    return result;
 }
 
 void TerminalDisplay::clearSelection()
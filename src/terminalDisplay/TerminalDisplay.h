@@ -9,11 +9,13 @@
 #define TERMINALDISPLAY_H
 
 // Qt
+#include <QCache>
 #include <QColor>
 #include <QPointer>
 #include <QWidget>
 
 #include <memory>
+#include <utility>
 
 // Konsole
 #include "../characters/Character.h"
@@ -750,6 +752,8 @@ private:
     bool _cursorBlinking = false; // cursor is blinking, hide it when drawing
     bool _cursorAnimating = false; // cursor is animating, animate it when drawing
     bool _hasTextBlinker = false; // has characters to blink
+    QVector<bool> _blinkingLines; // lines of _image which have characters to blink
+    bool _compareAllLines = true; // _image may differ from the window on any line
     QTimer *_blinkTextTimer = nullptr;
     QTimer *_blinkCursorTimer = nullptr;
 
@@ -843,6 +847,17 @@ private:
     bool _semanticInputClick = false;
 
     UBiDi *ubidi = nullptr;
+
+    // results of bidiMap() for lines which need shaping or reordering,
+    // by the text of the line and whether it was shaped and reordered
+    struct BidiLine {
+        QString line;
+        QVector<int> log2line;
+        QVector<uint16_t> shapemap;
+        QVector<int32_t> vis2line;
+        bool shaped = false;
+    };
+    mutable QCache<std::pair<QString, int>, BidiLine> _bidiCache;
     QPoint _visualCursorPosition = {0, 0};
 
     int _selModeModifiers = 0;
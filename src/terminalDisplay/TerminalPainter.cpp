@@ -23,12 +23,15 @@
 #include <QColor>
 #include <QDebug>
 #include <QElapsedTimer>
+#include <QFontMetricsF>
+#include <QPaintDevice>
 #include <QPainter>
 #include <QPainterPath>
 #include <QPen>
 #include <QRect>
 #include <QRegion>
 #include <QString>
+#include <QTextLayout>
 #include <QTransform>
 #include <QtMath>
 
@@ -57,6 +60,7 @@ QVariant interpolatePolygonF(const QPolygonF &start, const QPolygonF &end, qreal
 TerminalPainter::TerminalPainter(TerminalDisplay *parent)
     : QObject(parent)
     , m_parentDisplay(parent)
+    , m_textCache(4096)
 {
     qRegisterAnimationInterpolator<QPolygonF>(interpolatePolygonF);
     m_cursorAnim = new QVariantAnimation(this);
@@ -1247,7 +1251,13 @@ void TerminalPainter::drawTextCharacters(QPainter &painter,
             // We shift half way down here to center
             y += m_parentDisplay->terminalFont()->lineSpacing() / 2;
         }
-        painter.drawText(rect.x(), y, text);
+        // the layout of a cached text is only valid without scaling, which
+        // double width and double height lines use
+        if (!printerFriendly && painter.worldTransform().type() <= QTransform::TxTranslate) {
+            drawCachedText(painter, rect.x(), y, text);
+        } else {
+            painter.drawText(rect.x(), y, text);
+        }
         if (0 && text.toUcs4().length() >= 1) {
             fprintf(stderr, " %lli  ", (qint64)text.toUcs4().length());
             for (int i = 0; i < text.toUcs4().length(); i++) {
@@ -1260,4 +1270,37 @@ void TerminalPainter::drawTextCharacters(QPainter &painter,
         painter.setFont(savedFont);
     }
 }
+
+void TerminalPainter::drawCachedText(QPainter &painter, int x, int y, const QString &text)
+{
+    // glyph positions are rounded for the device pixel ratio
+    const qreal devicePixelRatio = painter.device()->devicePixelRatioF();
+    if (devicePixelRatio != m_textCacheDevicePixelRatio) {
+        m_textCache.clear();
+        m_textCacheDevicePixelRatio = devicePixelRatio;
+    }
+
+    const std::pair<QString, QFont> key(text, painter.font());
+    CachedText *cachedText = m_textCache.object(key);
+    if (cachedText == nullptr) {
+        QTextOption option;
+        option.setTextDirection(Qt::LeftToRight);
+
+        // a single layout gives both the glyphs, with any fallback fonts, and
+        // the ascent of the line they sit on
+        QTextLayout layout(text, key.second);
+        layout.setTextOption(option);
+        layout.beginLayout();
+        const QTextLine line = layout.createLine();
+        layout.endLayout();
+
+        cachedText = new CachedText{layout.glyphRuns(), line.isValid() ? line.ascent() : QFontMetricsF(key.second).ascent()};
+        m_textCache.insert(key, cachedText);
+    }
+
+    const QPointF topLeft(x, y - cachedText->ascent);
+    for (const QGlyphRun &glyphRun : std::as_const(cachedText->glyphRuns)) {
+        painter.drawGlyphRun(topLeft, glyphRun);
+    }
+}
 }
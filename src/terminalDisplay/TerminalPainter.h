@@ -10,8 +10,11 @@
 #define TERMINALPAINTER_HPP
 
 // Qt
+#include <QCache>
+#include <QFont>
 #include <QPolygonF>
 #include <QRectF>
+#include <QGlyphRun>
 #include <QVariantAnimation>
 #include <QVector>
 
@@ -23,6 +26,8 @@
 #include "profile/Profile.h"
 #include "terminalDisplay/TerminalDisplay.h"
 
+#include <utility>
+
 class QRect;
 class QColor;
 class QRegion;
@@ -135,11 +140,23 @@ private:
                             QColor oldColor,
                             QFont::Weight normalWeight,
                             QFont::Weight boldWeight);
+    // draws text with cached glyph runs, so that the text is only laid out once
+    void drawCachedText(QPainter &painter, int x, int y, const QString &text);
+
     void updateCursorAnimation(const QVariant &value);
     void onCursorPositionChanged(const QRectF &oldRect, const QRectF &newRect);
     QVariantAnimation *m_cursorAnim;
     QRectF m_lastTargetRect;
     QPolygonF m_animatedCursorPolygon;
+
+    // laid out text fragments, by text and font
+    struct CachedText {
+        QList<QGlyphRun> glyphRuns;
+        // the glyphs are positioned from the top of the line
+        qreal ascent;
+    };
+    QCache<std::pair<QString, QFont>, CachedText> m_textCache;
+    qreal m_textCacheDevicePixelRatio = 0;
 };
 
 }
@@ -281,9 +281,12 @@ void TerminalScrollBar::paintEvent(QPaintEvent *event)
     p.setPen(Qt::NoPen);
 
     p.setBrush(searchLineColor);
-    for (int y: std::as_const(_searchLines)) {
-        y = (y * height()) / _terminalLines;
-        p.drawRoundedRect(2, y, width() - 4, stripeHeight, cornerRadius, cornerRadius);
+    if (!_searchLines.isEmpty()) {
+        for (int y = 0; y < _searchBuckets.size(); ++y) {
+            if (_searchBuckets.at(y) >= 0) {
+                p.drawRoundedRect(2, y, width() - 4, stripeHeight, cornerRadius, cornerRadius);
+            }
+        }
     }
 
     for (int i = 0; i < _markers.size(); ++i) {
@@ -292,28 +295,67 @@ void TerminalScrollBar::paintEvent(QPaintEvent *event)
     }
 }
 
-void TerminalScrollBar::searchLines(const QSet<int>& indexSet, int lines) {
-    if (indexSet.isEmpty()) {
-        _searchLines.clear();
+void TerminalScrollBar::addSearchLines(const QList<int> &lines, int terminalLines)
+{
+    _searchLines.append(lines);
+
+    if (terminalLines != _terminalLines) {
+        _terminalLines = terminalLines;
+        regenerateSearchBuckets();
     } else {
-        _searchLines = indexSet;
+        for (int line : lines) {
+            addSearchBucket(line);
+        }
     }
 
-    if(sender()) {
-        _terminalLines = lines;
-    }
+    update();
+}
 
+void TerminalScrollBar::clearSearchLines()
+{
+    _searchLines.clear();
+    regenerateSearchBuckets();
     update();
 }
 
-void TerminalScrollBar::clearSearchLines() {
-    searchLines(QSet<int>{}, 1000);
+void TerminalScrollBar::regenerateSearchBuckets()
+{
+    _searchBuckets.fill(-1, qMax(0, height()));
+    for (int line : std::as_const(_searchLines)) {
+        addSearchBucket(line);
+    }
+}
+
+void TerminalScrollBar::addSearchBucket(int line)
+{
+    if (_searchBuckets.isEmpty() || _terminalLines <= 0) {
+        return;
+    }
+
+    const int y = qBound(0, int(qint64(line) * height() / _terminalLines), int(_searchBuckets.size()) - 1);
+    int &bucket = _searchBuckets[y];
+    if (bucket < 0 || line < bucket) {
+        bucket = line;
+    }
+}
+
+int TerminalScrollBar::searchLineNear(int y) const
+{
+    for (int distance = 0; distance <= 3; ++distance) {
+        for (const int bucket : {y - distance, y + distance}) {
+            if (bucket >= 0 && bucket < _searchBuckets.size() && _searchBuckets.at(bucket) >= 0) {
+                return _searchBuckets.at(bucket);
+            }
+        }
+    }
+    return -1;
 }
 
 void TerminalScrollBar::resizeEvent(QResizeEvent *event)
 {
     QScrollBar::resizeEvent(event);
     regenerateMarkersGeometry();
+    regenerateSearchBuckets();
 }
 
 void TerminalScrollBar::mouseDoubleClickEvent(QMouseEvent *event)
@@ -328,21 +370,11 @@ void TerminalScrollBar::mouseDoubleClickEvent(QMouseEvent *event)
 }
 
 void TerminalScrollBar::mouseMoveEvent(QMouseEvent *event) {
-    int posY = event->pos().y();
-    bool showToolTip = false;
-
-    for (int y: std::as_const(_searchLines)) {
-        int x = y;
-        y = (y * height()) / _terminalLines;
-        if (abs(y - posY) <= 3) {
-            QString tooltipText = QString::fromUtf8("line %1").arg(x);
-            QToolTip::showText(event->globalPosition().toPoint(), tooltipText);
-            showToolTip = true;
-            break;
-        }
-    }
-
-    if (!showToolTip) {
+    const int line = searchLineNear(event->pos().y());
+    if (line >= 0) {
+        QString tooltipText = QString::fromUtf8("line %1").arg(line);
+        QToolTip::showText(event->globalPosition().toPoint(), tooltipText);
+    } else {
         QToolTip::hideText();
     }
 
@@ -102,7 +102,11 @@ public Q_SLOTS:
 
     void scrollBarPositionChanged(int value);
     void highlightScrolledLinesEvent();
-    void searchLines(const QSet<int>&, int);
+    /**
+     * Marks @p lines, out of @p terminalLines lines of output, as holding search results.
+     * The lines add to those of previous calls until clearSearchLines() is called.
+     */
+    void addSearchLines(const QList<int> &lines, int terminalLines);
     void clearSearchLines();
 
     // Reimplementation to paint scrollbar markers over the standard drawing
@@ -149,6 +153,14 @@ private:
 
     double markerHeight() const;
 
+    // Sorts the search result lines into one bucket per pixel row of the scrollbar
+    void regenerateSearchBuckets();
+
+    void addSearchBucket(int line);
+
+    // Returns the first search result line shown within a few pixels of @p y, or -1
+    int searchLineNear(int y) const;
+
     bool _scrollFullPage = false;
     bool _alternateScrolling = false;
     Enum::ScrollBarPositionEnum _scrollbarLocation = Enum::ScrollBarRight;
@@ -157,7 +169,9 @@ private:
     QColor _markerColor;
     double _markerPSize = 2.0;
     QList<Marker *> _markers;
-    QSet<int> _searchLines;
+    QList<int> _searchLines;
+    // the first search result line shown in each pixel row, or -1
+    QList<int> _searchBuckets;
     int _terminalLines = 1;
     QColor _searchHighlightLineColor;
     int _lineOpacity = 100;
@@ -0,0 +1,368 @@
+/*
+    SPDX-FileCopyrightText: 2026 Konsole Plus contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+/*
+   konsole-plus-bench: feeds recorded or synthetic terminal output through the
+   emulation pipeline (Vt102Emulation -> Screen -> CompactHistoryScroll) the same
+   way Session::onReceiveBlock() does, without a pty or a visible window, and
+   reports the throughput of each scenario.
+
+   Usage: konsole-plus-bench [--json results.json] [--scenario filter] [recording...]
+*/
+
+// Standard
+#include <cstdio>
+
+// Qt
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+
+// Konsole
+#include "../Screen.h"
+#include "../Vt102Emulation.h"
+#include "../history/compact/CompactHistoryType.h"
+#include "../terminalDisplay/TerminalDisplay.h"
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+using namespace Konsole;
+
+namespace
+{
+// Size of the blocks handed to the emulation, roughly what a pty read returns
+const int BlockSize = 4096;
+
+const int ScreenLines = 50;
+const int ScreenColumns = 200;
+
+// Gives access to both screens, so they can be attached to the hidden display
+class BenchmarkEmulation : public Vt102Emulation
+{
+public:
+    void setTerminalDisplay(TerminalDisplay *display)
+    {
+        _screen[0]->setCurrentTerminalDisplay(display);
+        _screen[1]->setCurrentTerminalDisplay(display);
+    }
+};
+
+struct Scenario {
+    QString name;
+    QByteArray data;
+};
+
+struct Result {
+    QString name;
+    qint64 bytes = 0;
+    qint64 codePoints = 0;
+    qint64 nanoseconds = 0;
+    qint64 peakRssKiB = 0;
+};
+
+QByteArray sgrColourStream()
+{
+    QByteArray data;
+    QRandomGenerator random(42);
+    for (int line = 0; line < 2000; ++line) {
+        for (int word = 0; word < 12; ++word) {
+            switch (word % 4) {
+            case 0:
+                data += QByteArray("\033[38;5;") + QByteArray::number(random.bounded(256)) + 'm';
+                break;
+            case 1:
+                data += QByteArray("\033[1;") + QByteArray::number(31 + random.bounded(7)) + 'm';
+                break;
+            case 2:
+                data += QByteArray("\033[48;2;") + QByteArray::number(random.bounded(256)) + ';' + QByteArray::number(random.bounded(256)) + ';'
+                    + QByteArray::number(random.bounded(256)) + 'm';
+                break;
+            default:
+                data += "\033[0m";
+                break;
+            }
+            data += "token";
+            data += QByteArray::number(line * 12 + word);
+            data += ' ';
+        }
+        data += "\033[0m\r\n";
+    }
+    return data;
+}
+
+QByteArray tuiStream()
+{
+    // Full-screen redraws with cursor addressing, similar to what htop or mc produce
+    QByteArray data("\033[?1049h\033[?25l");
+    QRandomGenerator random(7);
+    for (int frame = 0; frame < 100; ++frame) {
+        data += "\033[H\033[1;1r";
+        for (int row = 1; row <= ScreenLines; ++row) {
+            data += "\033[" + QByteArray::number(row) + ";1H";
+            data += "\033[" + QByteArray::number(30 + row % 8) + "m";
+            data += QByteArray::number(random.bounded(100000)).rightJustified(6);
+            data += " \xe2\x94\x82 ";
+            const int bar = random.bounded(60);
+            for (int i = 0; i < bar; ++i) {
+                data += "\xe2\x96\x88";
+            }
+            data += "\033[0m\033[K";
+        }
+        data += "\033[" + QByteArray::number(ScreenLines) + ";" + QByteArray::number(ScreenColumns - 10) + "H";
+        data += "\033[7m F10 Quit \033[0m";
+    }
+    data += "\033[?25h\033[?1049l";
+    return data;
+}
+
+QByteArray sixelStream()
+{
+    QByteArray data;
+    for (int image = 0; image < 20; ++image) {
+        data += "\033Pq\"1;1;128;60";
+        data += "#0;2;100;0;0#1;2;0;100;0#2;2;0;0;100";
+        for (int band = 0; band < 10; ++band) {
+            for (int color = 0; color < 3; ++color) {
+                data += '#' + QByteArray::number(color);
+                for (int x = 0; x < 128; x += 8) {
+                    data += char('?' + ((x / 8 + band + color) % 63));
+                    data += "!7~";
+                }
+                data += '$';
+            }
+            data += '-';
+        }
+        data += "\033\\\r\n";
+    }
+    return data;
+}
+
+QByteArray kittyStream()
+{
+    const int size = 64;
+    QByteArray pixels(size * size * 4, Qt::Uninitialized);
+    for (int i = 0; i < pixels.size(); ++i) {
+        pixels[i] = char(i * 7);
+    }
+    const QByteArray payload = pixels.toBase64();
+
+    QByteArray data;
+    for (int image = 0; image < 20; ++image) {
+        // transmit and display in chunks, suppressing all replies
+        for (int offset = 0; offset < payload.size(); offset += BlockSize) {
+            const bool last = offset + BlockSize >= payload.size();
+            data += "\033_G";
+            if (offset == 0) {
+                data += "a=T,q=2,f=32,s=" + QByteArray::number(size) + ",v=" + QByteArray::number(size) + ',';
+            }
+            data += last ? "m=0;" : "m=1;";
+            data += payload.mid(offset, BlockSize);
+            data += "\033\\";
+        }
+        data += "\r\n";
+    }
+    return data;
+}
+
+QList<Scenario> builtinScenarios()
+{
+    QList<Scenario> scenarios;
+
+    const QDir textFiles(QStringLiteral(KONSOLE_TEXT_FILES_DIR));
+    const QStringList files = textFiles.entryList({QStringLiteral("*.txt")}, QDir::Files, QDir::Name);
+    for (const QString &file : files) {
+        QFile f(textFiles.filePath(file));
+        if (f.open(QIODevice::ReadOnly)) {
+            // files are stored with bare newlines, the tty would add the carriage returns
+            scenarios.append({QStringLiteral("text-files/") + file, f.readAll().replace("\n", "\r\n")});
+        }
+    }
+
+    scenarios.append({QStringLiteral("synthetic/sgr-colours"), sgrColourStream()});
+    scenarios.append({QStringLiteral("synthetic/tui-cursor-addressing"), tuiStream()});
+    scenarios.append({QStringLiteral("synthetic/sixel"), sixelStream()});
+    scenarios.append({QStringLiteral("synthetic/kitty-graphics"), kittyStream()});
+
+    return scenarios;
+}
+
+void resetPeakRss()
+{
+#ifdef Q_OS_LINUX
+    // Writing 5 resets the "high water mark" reported as VmHWM, see proc(5)
+    QFile clearRefs(QStringLiteral("/proc/self/clear_refs"));
+    if (clearRefs.open(QIODevice::WriteOnly)) {
+        clearRefs.write("5");
+    }
+#endif
+}
+
+qint64 peakRssKiB()
+{
+#ifdef Q_OS_LINUX
+    QFile status(QStringLiteral("/proc/self/status"));
+    if (status.open(QIODevice::ReadOnly)) {
+        const QList<QByteArray> lines = status.readAll().split('\n');
+        for (const QByteArray &line : lines) {
+            if (line.startsWith("VmHWM:")) {
+                return line.mid(6).trimmed().split(' ').value(0).toLongLong();
+            }
+        }
+    }
+#endif
+#ifdef Q_OS_UNIX
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef Q_OS_MACOS
+        return usage.ru_maxrss / 1024;
+#else
+        return usage.ru_maxrss;
+#endif
+    }
+#endif
+    return 0;
+}
+
+Result run(const Scenario &scenario, qint64 minimumBytes, int historyLines)
+{
+    Result result;
+    result.name = scenario.name;
+
+    if (scenario.data.isEmpty()) {
+        return result;
+    }
+
+    const int repeats = int(qMax<qint64>(1, (minimumBytes + scenario.data.size() - 1) / scenario.data.size()));
+    const qint64 codePointsPerRepeat = QString::fromUtf8(scenario.data).toUcs4().size();
+
+    resetPeakRss();
+
+    {
+        // the display is never shown, it only provides font metrics for image placements
+        TerminalDisplay display(nullptr);
+        BenchmarkEmulation emulation;
+        emulation.setCodec(QByteArrayLiteral("UTF-8"));
+        emulation.setHistory(CompactHistoryType(historyLines));
+        emulation.setImageSize(ScreenLines, ScreenColumns);
+        emulation.reset();
+        emulation.setTerminalDisplay(&display);
+
+        const char *data = scenario.data.constData();
+        const int size = scenario.data.size();
+
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < repeats; ++i) {
+            for (int offset = 0; offset < size; offset += BlockSize) {
+                emulation.receiveData(data + offset, qMin(BlockSize, size - offset));
+            }
+        }
+        result.nanoseconds = timer.nsecsElapsed();
+    }
+
+    result.bytes = qint64(scenario.data.size()) * repeats;
+    result.codePoints = codePointsPerRepeat * repeats;
+    result.peakRssKiB = peakRssKiB();
+    return result;
+}
+}
+
+int main(int argc, char **argv)
+{
+    // headless by default, the benchmark never shows a window
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QApplication app(argc, argv);
+    QApplication::setApplicationName(QStringLiteral("konsole-plus-bench"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Measures terminal emulation throughput on recorded and synthetic output"));
+    parser.addHelpOption();
+    const QCommandLineOption jsonOption(QStringLiteral("json"), QStringLiteral("Write machine-readable results to <file>."), QStringLiteral("file"));
+    const QCommandLineOption scenarioOption(QStringLiteral("scenario"),
+                                            QStringLiteral("Only run scenarios whose name contains <filter>."),
+                                            QStringLiteral("filter"));
+    const QCommandLineOption bytesOption(QStringLiteral("min-bytes"),
+                                         QStringLiteral("Repeat each input until at least <bytes> were processed (default 16 MiB)."),
+                                         QStringLiteral("bytes"),
+                                         QStringLiteral("16777216"));
+    const QCommandLineOption historyOption(QStringLiteral("history-lines"),
+                                           QStringLiteral("Scrollback size of the compact history (default 10000)."),
+                                           QStringLiteral("lines"),
+                                           QStringLiteral("10000"));
+    parser.addOptions({jsonOption, scenarioOption, bytesOption, historyOption});
+    parser.addPositionalArgument(QStringLiteral("recording"), QStringLiteral("Raw pty output captured to a file, e.g. with script(1)."), QStringLiteral("[recording...]"));
+    parser.process(app);
+
+    QList<Scenario> scenarios = builtinScenarios();
+    const QStringList recordings = parser.positionalArguments();
+    for (const QString &path : recordings) {
+        QFile f(path);
+        if (!f.open(QIODevice::ReadOnly)) {
+            fprintf(stderr, "Cannot read %s\n", qPrintable(path));
+            return 1;
+        }
+        scenarios.append({QStringLiteral("recording/") + QFileInfo(path).fileName(), f.readAll()});
+    }
+
+    const QString filter = parser.value(scenarioOption);
+    const qint64 minimumBytes = parser.value(bytesOption).toLongLong();
+    const int historyLines = parser.value(historyOption).toInt();
+
+    QJsonArray results;
+    printf("%-40s %12s %12s %12s\n", "scenario", "MB/s", "ns/cp", "peak RSS KiB");
+    for (const Scenario &scenario : std::as_const(scenarios)) {
+        if (!filter.isEmpty() && !scenario.name.contains(filter)) {
+            continue;
+        }
+
+        const Result result = run(scenario, minimumBytes, historyLines);
+        const double seconds = result.nanoseconds / 1e9;
+        const double megabytesPerSecond = seconds > 0 ? result.bytes / 1e6 / seconds : 0;
+        const double nsPerCodePoint = result.codePoints > 0 ? double(result.nanoseconds) / result.codePoints : 0;
+
+        printf("%-40s %12.1f %12.2f %12lld\n", qPrintable(result.name), megabytesPerSecond, nsPerCodePoint, result.peakRssKiB);
+        fflush(stdout);
+
+        results.append(QJsonObject{
+            {QStringLiteral("scenario"), result.name},
+            {QStringLiteral("bytes"), result.bytes},
+            {QStringLiteral("codePoints"), result.codePoints},
+            {QStringLiteral("nanoseconds"), result.nanoseconds},
+            {QStringLiteral("mbPerSecond"), megabytesPerSecond},
+            {QStringLiteral("nsPerCodePoint"), nsPerCodePoint},
+            {QStringLiteral("peakRssKiB"), result.peakRssKiB},
+        });
+    }
+
+    if (parser.isSet(jsonOption)) {
+        QFile out(parser.value(jsonOption));
+        if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            fprintf(stderr, "Cannot write %s\n", qPrintable(out.fileName()));
+            return 1;
+        }
+        const QJsonObject document{
+            {QStringLiteral("historyLines"), historyLines},
+            {QStringLiteral("screenLines"), ScreenLines},
+            {QStringLiteral("screenColumns"), ScreenColumns},
+            {QStringLiteral("results"), results},
+        };
+        out.write(QJsonDocument(document).toJson());
+    }
+
+    return 0;
+}
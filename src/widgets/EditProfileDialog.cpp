@@ -1764,6 +1764,13 @@ void EditProfileDialog::setupScrollingPage(const Profile::Ptr &profile)
     const int historySize = profile->historySize();
     _scrollingUi->historySizeWidget->setLineCount(historySize);
 
+    // setup scrollback compression
+    _scrollingUi->historySizeWidget->setCompressed(profile->property<bool>(Profile::HistoryCompression));
+    connect(_scrollingUi->historySizeWidget,
+            &Konsole::HistorySizeWidget::historyCompressionChanged,
+            this,
+            &Konsole::EditProfileDialog::historyCompressionChanged);
+
     // setup scrollpageamount type radio
     auto scrollFullPage = profile->property<int>(Profile::ScrollFullPage);
 
@@ -1779,6 +1786,9 @@ void EditProfileDialog::setupScrollingPage(const Profile::Ptr &profile)
     _scrollingUi->reflowLinesButton->setChecked(profile->property<bool>(Profile::ReflowLines));
     connect(_scrollingUi->reflowLinesButton, &QPushButton::clicked, this, &EditProfileDialog::toggleReflowLines);
 
+    _scrollingUi->historySearchIndexButton->setChecked(profile->property<bool>(Profile::HistorySearchIndex));
+    connect(_scrollingUi->historySearchIndexButton, &QPushButton::clicked, this, &EditProfileDialog::toggleHistorySearchIndex);
+
     // setup marker color button
     _scrollingUi->markerColorButton->setColor(profile->property<QColor>(Profile::MarkerColor));
     connect(_scrollingUi->markerColorButton, &KColorButton::changed, this, &Konsole::EditProfileDialog::toggleScrollbarMarkerColor);
@@ -1808,6 +1818,11 @@ void EditProfileDialog::historyModeChanged(Enum::HistoryModeEnum mode)
     updateTempProfileProperty(Profile::HistoryMode, mode);
 }
 
+void EditProfileDialog::historyCompressionChanged(bool compressed)
+{
+    updateTempProfileProperty(Profile::HistoryCompression, compressed);
+}
+
 void EditProfileDialog::scrollFullPage()
 {
     updateTempProfileProperty(Profile::ScrollFullPage, Enum::ScrollPageFull);
@@ -1828,6 +1843,11 @@ void EditProfileDialog::toggleReflowLines(bool enable)
     updateTempProfileProperty(Profile::ReflowLines, enable);
 }
 
+void EditProfileDialog::toggleHistorySearchIndex(bool enable)
+{
+    updateTempProfileProperty(Profile::HistorySearchIndex, enable);
+}
+
 void EditProfileDialog::toggleScrollbarMarkerColor(QColor color)
 {
     updateTempProfileProperty(Profile::MarkerColor, color);
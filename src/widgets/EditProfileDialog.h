@@ -182,11 +182,13 @@ private Q_SLOTS:
     void historyModeChanged(Enum::HistoryModeEnum mode);
 
     void historySizeChanged(int);
+    void historyCompressionChanged(bool compressed);
 
     void scrollFullPage();
     void scrollHalfPage();
     void toggleHighlightScrolledLines(bool enable);
     void toggleReflowLines(bool enable);
+    void toggleHistorySearchIndex(bool enable);
 
     void toggleScrollbarMarkerColor(QColor color);
     void toggleScrollbarMarkerSize(double pSize);
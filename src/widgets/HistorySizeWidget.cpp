@@ -45,6 +45,8 @@ HistorySizeWidget::HistorySizeWidget(QWidget *parent)
             this,
             &Konsole::HistorySizeWidget::historySizeChanged);
 
+    connect(_ui->compressHistoryButton, &QAbstractButton::toggled, this, &Konsole::HistorySizeWidget::historyCompressionChanged);
+
     auto warningButtonSizePolicy = _ui->fixedSizeHistoryWarningButton->sizePolicy();
     warningButtonSizePolicy.setRetainSizeWhenHidden(true);
 
@@ -80,6 +82,9 @@ HistorySizeWidget::HistorySizeWidget(QWidget *parent)
     const int radioButtonHeight = _ui->fixedSizeHistoryWrapper->sizeHint().height();
     _ui->noHistoryButton->setMinimumHeight(radioButtonHeight);
     _ui->unlimitedHistoryButton->setMinimumHeight(radioButtonHeight);
+
+    // there is nothing to compress without history
+    connect(_ui->noHistoryButton, &QAbstractButton::toggled, _ui->compressHistoryButton, &QWidget::setDisabled);
 }
 
 HistorySizeWidget::~HistorySizeWidget()
@@ -129,6 +134,16 @@ int HistorySizeWidget::lineCount() const
     return _ui->historyLineSpinner->value();
 }
 
+void HistorySizeWidget::setCompressed(bool compressed)
+{
+    _ui->compressHistoryButton->setChecked(compressed);
+}
+
+bool HistorySizeWidget::isCompressed() const
+{
+    return _ui->compressHistoryButton->isChecked();
+}
+
 int HistorySizeWidget::preferredLabelHeight()
 {
     Q_ASSERT(_ui);
@@ -50,6 +50,12 @@ public:
      */
     int lineCount() const;
 
+    /** Sets whether the older lines of history are kept compressed. */
+    void setCompressed(bool compressed);
+
+    /** Returns whether the user chose to compress the history. */
+    bool isCompressed() const;
+
     /**
      * Return height which should be set on the widget's label
      * to align with the first widget's item
@@ -63,6 +69,9 @@ Q_SIGNALS:
     /** Emitted when the history size is changed. */
     void historySizeChanged(int);
 
+    /** Emitted when history compression is turned on or off. */
+    void historyCompressionChanged(bool);
+
 private Q_SLOTS:
     void buttonClicked(QAbstractButton *);
 